@@ -0,0 +1,165 @@
+#include "arena.h"
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+static FrameArena arenas[FRAME_ARENA_MAX_THREADS];
+static FrameArenaResource* resources[FRAME_ARENA_MAX_THREADS];
+static int arenaCount = 0;
+static std::atomic<int> claimed(0);
+static thread_local int threadArena = -1;
+
+bool initFrameArena(FrameArena& arena, std::size_t capacity, bool hugePages) {
+    arena = FrameArena{NULL, capacity, 0, 0, 0, false, false};
+#ifdef __linux__
+    if (hugePages) {
+        std::size_t rounded = (capacity + FRAME_ARENA_HUGE_PAGE - 1) / FRAME_ARENA_HUGE_PAGE * FRAME_ARENA_HUGE_PAGE;
+        void* p = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                       -1, 0);
+        if (p != MAP_FAILED) {
+            arena.base = static_cast<char*>(p);
+            arena.capacity = rounded;
+            arena.hugePages = true;
+        } else {
+            // No reserved huge pages; transparent ones need a 2 MB aligned
+            // region, so over-map and trim
+            std::size_t span = rounded + FRAME_ARENA_HUGE_PAGE;
+            p = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                char* start = static_cast<char*>(p);
+                char* aligned = reinterpret_cast<char*>(
+                    (reinterpret_cast<std::uintptr_t>(start) + FRAME_ARENA_HUGE_PAGE - 1) & ~(FRAME_ARENA_HUGE_PAGE - 1));
+                if (aligned > start) munmap(start, aligned - start);
+                if (start + span > aligned + rounded) munmap(aligned + rounded, start + span - (aligned + rounded));
+                arena.base = aligned;
+                arena.capacity = rounded;
+                arena.hugePages = madvise(aligned, rounded, MADV_HUGEPAGE) == 0;
+                memset(arena.base, 0, arena.capacity);
+            }
+        }
+        if (arena.base) {
+            arena.mapped = true;
+            return true;
+        }
+        LOG_WARN(LogCategory::CORE, "Huge pages unavailable for the frame arena");
+    }
+#else
+    (void)hugePages;
+#endif
+    arena.base = static_cast<char*>(std::malloc(capacity));
+    if (!arena.base) {
+        LOG_ERROR(LogCategory::CORE, "Failed to allocate a {} byte frame arena", capacity);
+        arena.capacity = 0;
+        return false;
+    }
+    // Fault the pages in now rather than in the first frames that use them
+    memset(arena.base, 0, capacity);
+    return true;
+}
+
+void destroyFrameArena(FrameArena& arena) {
+    if (!arena.base) return;
+#ifdef __linux__
+    if (arena.mapped) {
+        munmap(arena.base, arena.capacity);
+    } else {
+        std::free(arena.base);
+    }
+#else
+    std::free(arena.base);
+#endif
+    arena.base = NULL;
+    arena.capacity = 0;
+    arena.used = 0;
+}
+
+void* arenaAllocate(FrameArena& arena, std::size_t size, std::size_t alignment) {
+    std::size_t offset = (arena.used + alignment - 1) & ~(alignment - 1);
+    if (offset + size > arena.capacity) return NULL;
+    arena.used = offset + size;
+    return arena.base + offset;
+}
+
+void resetFrameArena(FrameArena& arena) {
+    arena.highWater = std::max(arena.highWater, arena.used);
+    arena.used = 0;
+}
+
+void* FrameArenaResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* p = arenaAllocate(*arena, bytes, alignment);
+    if (p) return p;
+    arena->overflows++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void FrameArenaResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    char* c = static_cast<char*>(p);
+    if (c >= arena->base && c < arena->base + arena->capacity) return;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool FrameArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+bool initFrameArenas(int threads, std::size_t capacity, bool hugePages) {
+    arenaCount = 0;
+    claimed.store(0, std::memory_order_relaxed);
+    threads = std::min(threads, FRAME_ARENA_MAX_THREADS);
+    for (int i = 0; i < threads; i++) {
+        if (!initFrameArena(arenas[i], capacity, hugePages)) break;
+        resources[i] = new FrameArenaResource(&arenas[i]);
+        arenaCount++;
+    }
+    return arenaCount == threads;
+}
+
+void destroyFrameArenas() {
+    for (int i = 0; i < arenaCount; i++) {
+        delete resources[i];
+        resources[i] = NULL;
+        destroyFrameArena(arenas[i]);
+    }
+    arenaCount = 0;
+}
+
+FrameArena* frameArena() {
+    if (threadArena < 0) {
+        int index = claimed.fetch_add(1, std::memory_order_relaxed);
+        threadArena = index < arenaCount ? index : FRAME_ARENA_MAX_THREADS;
+    }
+    return threadArena < arenaCount ? &arenas[threadArena] : NULL;
+}
+
+std::pmr::memory_resource* frameResource() {
+    FrameArena* arena = frameArena();
+    return arena ? resources[arena - arenas] : std::pmr::new_delete_resource();
+}
+
+void resetFrameArenas() {
+    for (int i = 0; i < arenaCount; i++) {
+        resetFrameArena(arenas[i]);
+    }
+}
+
+FrameArenaStats frameArenaStats() {
+    FrameArenaStats stats = {std::min(claimed.load(std::memory_order_relaxed), arenaCount), 0, 0, 0, 0,
+                             arenaCount > 0};
+    for (int i = 0; i < arenaCount; i++) {
+        stats.capacity = arenas[i].capacity;
+        stats.used += arenas[i].used;
+        stats.highWater = std::max(stats.highWater, std::max(arenas[i].highWater, arenas[i].used));
+        stats.overflows += arenas[i].overflows;
+        stats.hugePages = stats.hugePages && arenas[i].hugePages;
+    }
+    return stats;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <cstddef>
+#include <memory_resource>
+
+// Threads with a frame arena; later threads fall back to the heap
+const int FRAME_ARENA_MAX_THREADS = 32;
+// Default size of each thread's arena
+const int FRAME_ARENA_DEFAULT_KB = 1024;
+// Huge-page backed arenas are rounded up to this
+const std::size_t FRAME_ARENA_HUGE_PAGE = 2u << 20;
+
+//structure
+// Bump-pointer region for data that lives until the end of the frame.
+// Nothing is freed on its own; resetFrameArena drops everything at once.
+struct FrameArena {
+    char* base;
+    std::size_t capacity;
+    std::size_t used;
+    std::size_t highWater;    // Most used in any frame since init
+    Uint64 overflows;         // Requests that didn't fit and went to the heap
+    bool hugePages;           // Backed by huge pages (MAP_HUGETLB or THP)
+    bool mapped;              // base came from mmap rather than malloc
+};
+
+// std::pmr adapter: standard containers built on it allocate from the arena
+// and fall back to the heap, counted as an overflow, when it is full.
+// Deallocation is free. Containers must be gone before the arena resets.
+struct FrameArenaResource : std::pmr::memory_resource {
+    FrameArena* arena;
+    explicit FrameArenaResource(FrameArena* frameArena) : arena(frameArena) {}
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+// All threads' arenas together, for reports
+struct FrameArenaStats {
+    int threads;              // Arenas claimed by a thread
+    std::size_t capacity;     // Per thread
+    std::size_t used;         // Summed over threads, this frame
+    std::size_t highWater;    // Highest of any thread
+    Uint64 overflows;
+    bool hugePages;           // Every arena got huge pages
+};
+
+//function definaction
+// Reserve and pre-fault capacity bytes. With hugePages, try explicit huge
+// pages, then transparent ones, then plain pages.
+bool initFrameArena(FrameArena& arena, std::size_t capacity, bool hugePages);
+void destroyFrameArena(FrameArena& arena);
+// NULL when the arena is full
+void* arenaAllocate(FrameArena& arena, std::size_t size, std::size_t alignment);
+void resetFrameArena(FrameArena& arena);
+
+// One arena per thread, claimed by the first frameArena call on it
+bool initFrameArenas(int threads, std::size_t capacity, bool hugePages);
+void destroyFrameArenas();
+// The calling thread's arena, or NULL once they are all claimed
+FrameArena* frameArena();
+// The calling thread's arena as a memory resource; the heap without one
+std::pmr::memory_resource* frameResource();
+// Reset every arena at the end of the frame, with no jobs in flight
+void resetFrameArenas();
+FrameArenaStats frameArenaStats();
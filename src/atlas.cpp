@@ -0,0 +1,166 @@
+#include "atlas.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool initAtlas(Atlas& atlas, int width, int height) {
+    atlas.width = 0;
+    atlas.height = 0;
+    atlas.regions.clear();
+    atlas.shelfX = 0;
+    atlas.shelfY = 0;
+    atlas.shelfH = 0;
+    atlas.surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!atlas.surface) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to create atlas: {}", SDL_GetError());
+        return false;
+    }
+    SDL_FillRect(atlas.surface, NULL, 0);
+    return true;
+}
+
+// Shelf packer: fill rows left to right, open a new shelf when one is full
+static bool packRect(Atlas& atlas, int w, int h, SDL_Rect& out) {
+    if (atlas.shelfX + w > atlas.surface->w) {
+        atlas.shelfY += atlas.shelfH + ATLAS_PADDING;
+        atlas.shelfX = 0;
+        atlas.shelfH = 0;
+    }
+    if (w > atlas.surface->w || atlas.shelfY + h > atlas.surface->h) return false;
+
+    out = {atlas.shelfX, atlas.shelfY, w, h};
+    atlas.shelfX += w + ATLAS_PADDING;
+    atlas.shelfH = std::max(atlas.shelfH, h);
+    return true;
+}
+
+// Copy pixels verbatim, alpha included
+static void copyPixels(SDL_Surface* src, const SDL_Rect& from, SDL_Surface* dst, const SDL_Rect& to) {
+    SDL_BlendMode mode;
+    SDL_GetSurfaceBlendMode(src, &mode);
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+    SDL_Rect s = from;
+    SDL_Rect d = to;
+    SDL_BlitSurface(src, &s, dst, &d);
+    SDL_SetSurfaceBlendMode(src, mode);
+}
+
+int atlasAdd(Atlas& atlas, SDL_Surface* src, const SDL_Rect& rect) {
+    AtlasRegion region = {{0, 0, rect.w, rect.h}, 0, 0, rect.w, rect.h};
+    if (!packRect(atlas, rect.w, rect.h, region.rect)) {
+        LOG_ERROR(LogCategory::ASSETS, "Atlas full adding {}x{} image", rect.w, rect.h);
+        return -1;
+    }
+    copyPixels(src, rect, atlas.surface, region.rect);
+    atlas.regions.push_back(region);
+    return static_cast<int>(atlas.regions.size()) - 1;
+}
+
+int atlasAddDisc(Atlas& atlas, int size, Uint32 rgb) {
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!s) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to create disc: {}", SDL_GetError());
+        return -1;
+    }
+    for (int y = 0; y < size; y++) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(s->pixels) + y * s->pitch);
+        for (int x = 0; x < size; x++) {
+            float dx = x + 0.5f - size * 0.5f, dy = y + 0.5f - size * 0.5f;
+            float d = std::sqrt(dx * dx + dy * dy) / (size * 0.5f);
+            Uint32 a = d >= 1.0f ? 0 : static_cast<Uint32>(255 * (1.0f - d * d));
+            row[x] = (a << 24) | (rgb & 0xffffffu);
+        }
+    }
+    SDL_Rect rect = {0, 0, size, size};
+    int region = atlasAdd(atlas, s, rect);
+    SDL_FreeSurface(s);
+    return region;
+}
+
+int atlasAddSolid(Atlas& atlas, int size, Uint32 rgb) {
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!s) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to create solid: {}", SDL_GetError());
+        return -1;
+    }
+    SDL_FillRect(s, NULL, 0xff000000u | (rgb & 0xffffffu));
+    SDL_Rect rect = {0, 0, size, size};
+    int region = atlasAdd(atlas, s, rect);
+    SDL_FreeSurface(s);
+    return region;
+}
+
+// Smallest rect holding every pixel with non-zero alpha
+static SDL_Rect opaqueBounds(const SDL_Surface* argb, const SDL_Rect& cell) {
+    int x0 = cell.w, y0 = cell.h, x1 = -1, y1 = -1;
+    for (int y = 0; y < cell.h; y++) {
+        const Uint32* row = reinterpret_cast<const Uint32*>(
+            static_cast<const Uint8*>(argb->pixels) + (cell.y + y) * argb->pitch) + cell.x;
+        for (int x = 0; x < cell.w; x++) {
+            if (row[x] >> 24) {
+                x0 = std::min(x0, x);
+                x1 = std::max(x1, x);
+                y0 = std::min(y0, y);
+                y1 = std::max(y1, y);
+            }
+        }
+    }
+    if (x1 < 0) return {0, 0, 0, 0};
+    return {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+}
+
+bool atlasAddSheet(Atlas& atlas, SDL_Surface* sheet, int frameW, int frameH, std::vector<int>& regionIds) {
+    SDL_Surface* argb = SDL_ConvertSurfaceFormat(sheet, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!argb) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to convert sheet for atlas: {}", SDL_GetError());
+        return false;
+    }
+
+    int columns = argb->w / frameW;
+    int cells = columns * (argb->h / frameH);
+    std::vector<SDL_Rect> trims(cells);
+    std::vector<int> order(cells);
+    SDL_LockSurface(argb);
+    for (int i = 0; i < cells; i++) {
+        SDL_Rect cell = {(i % columns) * frameW, (i / columns) * frameH, frameW, frameH};
+        trims[i] = opaqueBounds(argb, cell);
+        order[i] = i;
+    }
+    SDL_UnlockSurface(argb);
+
+    // Tallest first keeps shelves tight
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return trims[a].h > trims[b].h; });
+
+    bool ok = true;
+    regionIds.assign(cells, -1);
+    for (int i : order) {
+        const SDL_Rect& t = trims[i];
+        AtlasRegion region = {{0, 0, 0, 0}, t.x, t.y, frameW, frameH};
+        if (t.w > 0) {
+            if (!packRect(atlas, t.w, t.h, region.rect)) {
+                LOG_ERROR(LogCategory::ASSETS, "Atlas full packing sheet");
+                ok = false;
+                break;
+            }
+            SDL_Rect from = {(i % columns) * frameW + t.x, (i / columns) * frameH + t.y, t.w, t.h};
+            copyPixels(argb, from, atlas.surface, region.rect);
+        }
+        atlas.regions.push_back(region);
+        regionIds[i] = static_cast<int>(atlas.regions.size()) - 1;
+    }
+
+    SDL_FreeSurface(argb);
+    return ok;
+}
+
+void finalizeAtlas(Atlas& atlas) {
+    // Only the shelves in use are ever uploaded
+    atlas.width = atlas.surface->w;
+    atlas.height = std::max(1, atlas.shelfY + atlas.shelfH);
+}
+
+void destroyAtlas(Atlas& atlas) {
+    if (atlas.surface) SDL_FreeSurface(atlas.surface);
+    atlas.surface = NULL;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <vector>
+
+// Default atlas page size; only the rows actually used are uploaded
+const int ATLAS_SIZE = 512;
+// Gap between packed images so filtering never bleeds across them
+const int ATLAS_PADDING = 1;
+
+//structure
+// An image in the atlas. Trimmed images keep where their pixels sat inside
+// the original frame so render can offset the destination to match.
+struct AtlasRegion {
+    SDL_Rect rect;          // Pixels in the atlas; empty for fully transparent frames
+    int offsetX, offsetY;   // Top-left of rect within the untrimmed frame
+    int sourceW, sourceH;   // Untrimmed frame size
+};
+
+// Shared sprite atlas, packed on the CPU at load time. The render backend
+// uploads the used part once (or samples the surface directly on the CPU).
+struct Atlas {
+    SDL_Surface* surface;   // ARGB8888 pixels
+    int width, height;      // Used size, for normalising UVs
+    std::vector<AtlasRegion> regions;
+    int shelfX, shelfY, shelfH;
+};
+
+//function definaction
+bool initAtlas(Atlas& atlas, int width, int height);
+// Add an image untouched; returns its region id or -1 when the atlas is full
+int atlasAdd(Atlas& atlas, SDL_Surface* src, const SDL_Rect& rect);
+// Procedural soft-edged disc of the given colour (0xRRGGBB)
+int atlasAddDisc(Atlas& atlas, int size, Uint32 rgb);
+// Opaque square of the given colour (0xRRGGBB), for flat fills tinted per quad
+int atlasAddSolid(Atlas& atlas, int size, Uint32 rgb);
+// Trim every frameW x frameH cell of a sheet to its opaque bounds and pack
+// them tallest first. regionIds receives one id per cell, row-major.
+bool atlasAddSheet(Atlas& atlas, SDL_Surface* sheet, int frameW, int frameH, std::vector<int>& regionIds);
+// Fix the used size once everything is packed
+void finalizeAtlas(Atlas& atlas);
+void destroyAtlas(Atlas& atlas);
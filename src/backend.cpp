@@ -0,0 +1,486 @@
+#include "backend.h"
+#include "log.h"
+#include "profiler.h"
+#include "random.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const char* backendName(BackendType type) {
+    switch (type) {
+    case BackendType::AUTO: return "auto";
+    case BackendType::RENDERER: return "renderer";
+    case BackendType::SOFTWARE: return "software";
+    case BackendType::SURFACE: return "surface";
+    case BackendType::NONE: return "null";
+    default: return "?";
+    }
+}
+
+bool parseBackendType(const char* name, BackendType& type) {
+    for (int t = 0; t < static_cast<int>(BackendType::COUNT); t++) {
+        if (strcmp(name, backendName(static_cast<BackendType>(t))) == 0) {
+            type = static_cast<BackendType>(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool initRenderer(RenderBackend& backend, const Atlas& atlas, SceneTarget& scene) {
+    Uint32 flags = backend.type == BackendType::RENDERER ? SDL_RENDERER_ACCELERATED : SDL_RENDERER_SOFTWARE;
+    backend.renderer = SDL_CreateRenderer(backend.window, -1, flags | SDL_RENDERER_TARGETTEXTURE);
+    if (!backend.renderer) {
+        LOG_ERROR(LogCategory::RENDER, "SDL_CreateRenderer ({}) failed: {}", backendName(backend.type), SDL_GetError());
+        return false;
+    }
+
+    // Upload the used rows of the atlas once
+    backend.atlasTexture = SDL_CreateTexture(backend.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                             atlas.width, atlas.height);
+    if (!backend.atlasTexture) {
+        LOG_ERROR(LogCategory::RENDER, "Failed to create atlas texture: {}", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(backend.atlasTexture, SDL_BLENDMODE_BLEND);
+    SDL_UpdateTexture(backend.atlasTexture, NULL, atlas.surface->pixels, atlas.surface->pitch);
+
+    if (scene.width > 0) {
+        backend.sceneTexture = SDL_CreateTexture(backend.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                 SDL_TEXTUREACCESS_TARGET, scene.width, scene.height);
+        if (!backend.sceneTexture) {
+            // Fall back to full resolution
+            LOG_ERROR(LogCategory::RENDER, "Failed to create scene target: {}", SDL_GetError());
+            scene.width = 0;
+        } else {
+            SDL_SetTextureScaleMode(backend.sceneTexture,
+                                    scene.integerScale ? SDL_ScaleModeNearest : SDL_ScaleModeLinear);
+        }
+    }
+    return true;
+}
+
+// Formats the rasteriser can write straight into
+static bool rasterFormat(const SDL_Surface* surface) {
+    Uint32 format = surface->format->format;
+    return format == SDL_PIXELFORMAT_ARGB8888 || format == SDL_PIXELFORMAT_RGB888;
+}
+
+static bool initSurface(RenderBackend& backend, const Atlas& atlas, const SceneTarget& scene) {
+    // Premultiplied texels save the rasteriser a multiply per channel
+    if (!initRasterSource(backend.source, atlas, true)) return false;
+    initRasterBins(backend.bins);
+
+    backend.windowSurface = SDL_GetWindowSurface(backend.window);
+    if (!backend.windowSurface) {
+        LOG_ERROR(LogCategory::RENDER, "SDL_GetWindowSurface failed: {}", SDL_GetError());
+        return false;
+    }
+
+    // The rasteriser writes 32-bit xRGB; anything else is converted on present
+    if (scene.width == 0 && rasterFormat(backend.windowSurface)) {
+        backend.canvas = backend.windowSurface;
+        return true;
+    }
+
+    int w = scene.width > 0 ? scene.width : backend.windowSurface->w;
+    int h = scene.width > 0 ? scene.height : backend.windowSurface->h;
+    backend.canvas = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!backend.canvas) {
+        LOG_ERROR(LogCategory::RENDER, "Failed to create canvas: {}", SDL_GetError());
+        return false;
+    }
+    backend.ownsCanvas = true;
+    SDL_SetSurfaceBlendMode(backend.canvas, SDL_BLENDMODE_NONE);
+    return true;
+}
+
+bool initBackend(RenderBackend& backend, BackendType type, SDL_Window* window, const Atlas& atlas,
+                 SceneTarget& scene, JobSystem* jobs) {
+    backend = RenderBackend{};
+    backend.type = type;
+    backend.window = window;
+    backend.jobs = jobs;
+
+    bool ok = false;
+    switch (type) {
+    case BackendType::RENDERER:
+    case BackendType::SOFTWARE:
+        ok = initRenderer(backend, atlas, scene);
+        break;
+    case BackendType::SURFACE:
+        ok = initSurface(backend, atlas, scene);
+        break;
+    case BackendType::NONE:
+        ok = true;
+        break;
+    default:
+        LOG_ERROR(LogCategory::RENDER, "Backend {} can't be created directly", backendName(type));
+        break;
+    }
+    if (!ok) destroyBackend(backend);
+    return ok;
+}
+
+void destroyBackend(RenderBackend& backend) {
+    if (backend.sceneTexture) SDL_DestroyTexture(backend.sceneTexture);
+    if (backend.atlasTexture) SDL_DestroyTexture(backend.atlasTexture);
+    if (backend.renderer) SDL_DestroyRenderer(backend.renderer);
+    if (backend.ownsCanvas) SDL_FreeSurface(backend.canvas);
+    destroyRasterSource(backend.source);
+    // Let a renderer be created on this window again
+    if (backend.windowSurface) SDL_DestroyWindowSurface(backend.window);
+    SDL_Window* window = backend.window;
+    backend = RenderBackend{};
+    backend.type = BackendType::NONE;
+    backend.window = window;
+}
+
+bool setBackendDirtyRects(RenderBackend& backend, bool enabled, const SceneTarget& scene) {
+    // Only a canvas at window resolution maps damage one to one onto the window
+    backend.dirtyRects = enabled && backend.type == BackendType::SURFACE && scene.width == 0;
+    backend.partial = false;
+    backend.damage.clear();
+    backend.damageFraction = 1.0f;
+    invalidateRasterBins(backend.bins);
+    if (enabled && !backend.dirtyRects) {
+        LOG_WARN(LogCategory::RENDER, "Dirty rects need the surface backend without a scene target; drawing full frames");
+    }
+    return backend.dirtyRects;
+}
+
+void backendInvalidate(RenderBackend& backend) {
+    invalidateRasterBins(backend.bins);
+}
+
+bool initBackendFallback(RenderBackend& backend, BackendType first, SDL_Window* window, const Atlas& atlas,
+                         SceneTarget& scene, JobSystem* jobs) {
+    const BackendType order[] = {BackendType::RENDERER, BackendType::SOFTWARE, BackendType::SURFACE};
+    if (initBackend(backend, first, window, atlas, scene, jobs)) return true;
+    for (BackendType type : order) {
+        if (type == first) continue;
+        LOG_WARN(LogCategory::RENDER, "Falling back to the {} backend", backendName(type));
+        if (initBackend(backend, type, window, atlas, scene, jobs)) return true;
+    }
+    return false;
+}
+
+BackendType probeBackend(SDL_Window* window, const Atlas& atlas, const SceneTarget& scene,
+                         JobSystem* jobs, int logicalW, int logicalH) {
+    const BackendType candidates[] = {BackendType::RENDERER, BackendType::SOFTWARE, BackendType::SURFACE};
+    DrawList list;
+    initDrawList(list);
+    buildSyntheticDrawList(list, atlas, 2000, logicalW, logicalH);
+
+    BackendType best = BackendType::NONE;
+    double bestMs = 1e30;
+    std::cout << "Probing render backends:";
+    for (BackendType type : candidates) {
+        RenderBackend backend;
+        SceneTarget probeScene = scene;
+        if (!initBackend(backend, type, window, atlas, probeScene, jobs)) continue;
+
+        Uint64 total = 0;
+        for (int i = 0; i < BACKEND_PROBE_WARMUP + BACKEND_PROBE_FRAMES; i++) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            backendRender(backend, list, probeScene, logicalW, logicalH);
+            backendPresent(backend);
+            if (i >= BACKEND_PROBE_WARMUP) total += SDL_GetPerformanceCounter() - start;
+        }
+        destroyBackend(backend);
+
+        double ms = total * 1000.0 / SDL_GetPerformanceFrequency() / BACKEND_PROBE_FRAMES;
+        std::cout << " " << backendName(type) << " " << ms << " ms";
+        if (ms < bestMs) {
+            bestMs = ms;
+            best = type;
+        }
+    }
+    std::cout << "; using " << backendName(best) << std::endl;
+    return best;
+}
+
+// Execute the list on an SDL renderer
+static void submitDrawList(SDL_Renderer* renderer, SDL_Texture* atlas, const DrawList& list) {
+    SDL_SetRenderDrawColor(renderer, list.clearColor.r, list.clearColor.g, list.clearColor.b, list.clearColor.a);
+    SDL_RenderClear(renderer);
+
+    for (const DrawCommand& cmd : list.commands) {
+        switch (cmd.type) {
+        case DrawType::SPRITE:
+            SDL_RenderCopyExF(renderer, atlas, &cmd.src, &cmd.dst, 0, NULL, cmd.flip);
+            break;
+        case DrawType::QUADS:
+            SDL_RenderGeometry(renderer, atlas, &list.vertices[cmd.firstVertex], cmd.quadCount * 4,
+                               list.quadIndices.data(), cmd.quadCount * 6);
+            break;
+        case DrawType::LINE:
+            SDL_SetRenderDrawColor(renderer, cmd.color.r, cmd.color.g, cmd.color.b, cmd.color.a);
+            SDL_RenderDrawLineF(renderer, cmd.dst.x, cmd.dst.y, cmd.dst.x + cmd.dst.w, cmd.dst.y + cmd.dst.h);
+            break;
+        }
+    }
+}
+
+static void renderWithRenderer(RenderBackend& backend, const DrawList& list, const SceneTarget& scene,
+                               int logicalW, int logicalH) {
+    SDL_Renderer* renderer = backend.renderer;
+    if (!backend.sceneTexture) {
+        submitDrawList(renderer, backend.atlasTexture, list);
+        return;
+    }
+
+    // Scale applies to the current target, so this leaves the window's alone
+    SDL_SetRenderTarget(renderer, backend.sceneTexture);
+    SDL_RenderSetScale(renderer, static_cast<float>(scene.viewW) / logicalW,
+                       static_cast<float>(scene.viewH) / logicalH);
+    submitDrawList(renderer, backend.atlasTexture, list);
+    SDL_SetRenderTarget(renderer, NULL);
+
+    int outW, outH;
+    SDL_GetRendererOutputSize(renderer, &outW, &outH);
+    SDL_Rect src = {0, 0, scene.viewW, scene.viewH};
+    SDL_Rect dst = sceneOutputRect(scene, outW, outH);
+
+    // Letterbox whatever the blit leaves uncovered
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, backend.sceneTexture, &src, &dst);
+}
+
+// Rasterise into the canvas, in parallel tiles when there are workers
+static void rasterize(RenderBackend& backend, const SDL_Rect& clip, const DrawList& list, float scaleX, float scaleY) {
+    bool parallel = backend.jobs && backend.jobs->activeWorkers > 1;
+    if (parallel) {
+        rasterDrawListTiled(backend.canvas, clip, backend.source, list, scaleX, scaleY, backend.bins, *backend.jobs);
+    } else {
+        rasterDrawList(backend.canvas, clip, backend.source, list, scaleX, scaleY);
+    }
+}
+
+// Redraw only the damaged tiles of the canvas, which still holds last frame
+static void rasterizeDirty(RenderBackend& backend, const SDL_Rect& clip, const DrawList& list,
+                           float scaleX, float scaleY) {
+    bool parallel = backend.jobs && backend.jobs->activeWorkers > 1;
+    backend.partial = rasterDrawListDirty(backend.canvas, clip, backend.source, list, scaleX, scaleY, backend.bins,
+                                          parallel ? backend.jobs : NULL, backend.damage);
+    int area = 0;
+    for (const SDL_Rect& rect : backend.damage) area += rect.w * rect.h;
+    backend.damageFraction = clip.w > 0 && clip.h > 0 ? static_cast<float>(area) / (clip.w * clip.h) : 0.0f;
+}
+
+static void renderWithSurface(RenderBackend& backend, const DrawList& list,
+                              const SceneTarget& scene, int logicalW, int logicalH) {
+    SDL_Surface* window = backend.windowSurface;
+    if (scene.width == 0) {
+        // Full window resolution, converted on the way out if need be
+        SDL_Rect clip = {0, 0, backend.canvas->w, backend.canvas->h};
+        float scaleX = static_cast<float>(clip.w) / logicalW, scaleY = static_cast<float>(clip.h) / logicalH;
+        if (!backend.dirtyRects) {
+            rasterize(backend, clip, list, scaleX, scaleY);
+            if (backend.ownsCanvas) SDL_BlitSurface(backend.canvas, NULL, window, NULL);
+            return;
+        }
+        rasterizeDirty(backend, clip, list, scaleX, scaleY);
+        if (backend.ownsCanvas) {
+            for (SDL_Rect rect : backend.damage) SDL_BlitSurface(backend.canvas, &rect, window, &rect);
+        }
+        return;
+    }
+
+    SDL_Rect src = {0, 0, scene.viewW, scene.viewH};
+    rasterize(backend, src, list,
+              static_cast<float>(scene.viewW) / logicalW, static_cast<float>(scene.viewH) / logicalH);
+
+    // SDL's surface stretch is nearest-neighbour only, so dynamic resolution
+    // looks blockier here than on the renderer backends
+    SDL_Rect dst = sceneOutputRect(scene, window->w, window->h);
+    if (dst.w < window->w || dst.h < window->h) SDL_FillRect(window, NULL, 0);
+    SDL_BlitScaled(backend.canvas, &src, window, &dst);
+}
+
+static void countCommands(RenderBackend& backend, const DrawList& list) {
+    for (const DrawCommand& cmd : list.commands) {
+        switch (cmd.type) {
+        case DrawType::SPRITE: backend.sprites++; break;
+        case DrawType::QUADS: backend.quads += cmd.quadCount; break;
+        case DrawType::LINE: backend.lines++; break;
+        }
+    }
+}
+
+void backendRender(RenderBackend& backend, const DrawList& list, const SceneTarget& scene,
+                   int logicalW, int logicalH) {
+    PROFILE_SCOPE("backendRender");
+    backend.frames++;
+    backend.commands += list.commands.size();
+    switch (backend.type) {
+    case BackendType::RENDERER:
+    case BackendType::SOFTWARE:
+        renderWithRenderer(backend, list, scene, logicalW, logicalH);
+        break;
+    case BackendType::SURFACE:
+        renderWithSurface(backend, list, scene, logicalW, logicalH);
+        break;
+    default:
+        countCommands(backend, list);
+        break;
+    }
+}
+
+void backendFlush(RenderBackend& backend) {
+    if (backend.renderer) SDL_RenderFlush(backend.renderer);
+}
+
+void backendPresent(RenderBackend& backend) {
+    switch (backend.type) {
+    case BackendType::RENDERER:
+    case BackendType::SOFTWARE:
+        SDL_RenderPresent(backend.renderer);
+        break;
+    case BackendType::SURFACE:
+        if (!backend.partial) {
+            SDL_UpdateWindowSurface(backend.window);
+        } else if (!backend.damage.empty()) {
+            SDL_UpdateWindowSurfaceRects(backend.window, backend.damage.data(),
+                                         static_cast<int>(backend.damage.size()));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+bool initLayer(RenderBackend& backend, RenderLayer& layer, int width, int height) {
+    layer = RenderLayer{};
+    layer.width = width;
+    layer.height = height;
+    switch (backend.type) {
+    case BackendType::RENDERER:
+    case BackendType::SOFTWARE: {
+        layer.texture = SDL_CreateTexture(backend.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                          width, height);
+        if (!layer.texture) {
+            LOG_ERROR(LogCategory::RENDER, "Failed to create layer: {}", SDL_GetError());
+            return false;
+        }
+        // Blending into a transparent target leaves premultiplied colour;
+        // without custom blend modes edges come out slightly dark
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        if (SDL_SetTextureBlendMode(layer.texture, premultiplied) != 0) {
+            SDL_SetTextureBlendMode(layer.texture, SDL_BLENDMODE_BLEND);
+        }
+        return true;
+    }
+    case BackendType::SURFACE: {
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!surface) {
+            LOG_ERROR(LogCategory::RENDER, "Failed to create layer: {}", SDL_GetError());
+            return false;
+        }
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_BLEND);
+        layer.pixels = {surface, width, height, true, true};
+        return true;
+    }
+    default:
+        // The null backend has nothing to hold
+        return true;
+    }
+}
+
+void destroyLayer(RenderLayer& layer) {
+    if (layer.texture) SDL_DestroyTexture(layer.texture);
+    destroyRasterSource(layer.pixels);
+    layer = RenderLayer{};
+}
+
+void backendRenderLayer(RenderBackend& backend, RenderLayer& layer, const DrawList& list) {
+    if (layer.texture) {
+        SDL_SetRenderTarget(backend.renderer, layer.texture);
+        SDL_RenderSetScale(backend.renderer, 1.0f, 1.0f);
+        submitDrawList(backend.renderer, backend.atlasTexture, list);
+        SDL_SetRenderTarget(backend.renderer, NULL);
+    } else if (layer.pixels.pixels) {
+        SDL_Rect clip = {0, 0, layer.width, layer.height};
+        rasterDrawList(layer.pixels.pixels, clip, backend.source, list, 1.0f, 1.0f);
+    }
+}
+
+void backendCompositeLayer(RenderBackend& backend, const RenderLayer& layer, const SDL_FRect& dst,
+                           int logicalW, int logicalH) {
+    if (layer.texture) {
+        int outW, outH;
+        SDL_GetRendererOutputSize(backend.renderer, &outW, &outH);
+        float scaleX = static_cast<float>(outW) / logicalW, scaleY = static_cast<float>(outH) / logicalH;
+        SDL_FRect out = {dst.x * scaleX, dst.y * scaleY, dst.w * scaleX, dst.h * scaleY};
+        SDL_RenderCopyF(backend.renderer, layer.texture, NULL, &out);
+        return;
+    }
+    if (!layer.pixels.pixels) return;
+
+    SDL_Surface* window = backend.windowSurface;
+    float scaleX = static_cast<float>(window->w) / logicalW, scaleY = static_cast<float>(window->h) / logicalH;
+    SDL_FRect out = {dst.x * scaleX, dst.y * scaleY, dst.w * scaleX, dst.h * scaleY};
+    SDL_Rect clip = {0, 0, window->w, window->h};
+    SDL_Rect bounds = {static_cast<int>(out.x), static_cast<int>(out.y),
+                       static_cast<int>(std::ceil(out.x + out.w)) - static_cast<int>(out.x),
+                       static_cast<int>(std::ceil(out.y + out.h)) - static_cast<int>(out.y)};
+    if (!SDL_IntersectRect(&bounds, &clip, &bounds)) return;
+    if (rasterFormat(window)) {
+        rasterComposite(window, clip, layer.pixels, out);
+    } else {
+        // SDL's surface blend takes straight alpha, so soft edges darken a little
+        SDL_Rect rect = {static_cast<int>(out.x), static_cast<int>(out.y),
+                         static_cast<int>(out.w), static_cast<int>(out.h)};
+        SDL_BlitScaled(layer.pixels.pixels, NULL, window, &rect);
+    }
+
+    if (backend.dirtyRects) {
+        // The window under the layer no longer matches the canvas tiles:
+        // present it now and redraw those tiles under the next composite
+        damageRasterRect(backend.bins, bounds);
+        if (backend.partial) backend.damage.push_back(bounds);
+    }
+}
+
+void buildSyntheticDrawList(DrawList& list, const Atlas& atlas, int count, int logicalW, int logicalH) {
+    clearDrawList(list, {0, 0, 0, 255});
+    Uint32 rng = 0x2545f491u;
+
+    // Every non-empty region in turn, at its own size
+    std::vector<int> regions;
+    for (int i = 0; i < static_cast<int>(atlas.regions.size()); i++) {
+        if (atlas.regions[i].rect.w > 0) regions.push_back(i);
+    }
+    if (regions.empty()) return;
+
+    for (int i = 0; i < 16; i++) {
+        const SDL_Rect& r = atlas.regions[regions[i % regions.size()]].rect;
+        SDL_FRect dst = {randomRange(rng, 0, logicalW - r.w * 2.0f), randomRange(rng, 0, logicalH - r.h * 2.0f),
+                         r.w * 2.0f, r.h * 2.0f};
+        drawSprite(list, r, dst, (i & 1) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+    }
+
+    SDL_Vertex* out = beginQuads(list, count);
+    if (!out) return;
+    float invW = 1.0f / atlas.width, invH = 1.0f / atlas.height;
+    for (int i = 0; i < count; i++) {
+        const SDL_Rect& r = atlas.regions[regions[i % regions.size()]].rect;
+        float x0 = randomRange(rng, 0, static_cast<float>(logicalW - r.w));
+        float y0 = randomRange(rng, 0, static_cast<float>(logicalH - r.h));
+        float x1 = x0 + r.w, y1 = y0 + r.h;
+        float u0 = r.x * invW, v0 = r.y * invH, u1 = (r.x + r.w) * invW, v1 = (r.y + r.h) * invH;
+        SDL_Color c = {255, static_cast<Uint8>(nextRandom(rng)), static_cast<Uint8>(nextRandom(rng)), 200};
+        SDL_Vertex* q = &out[i * 4];
+        q[0] = {{x0, y0}, c, {u0, v0}};
+        q[1] = {{x1, y0}, c, {u1, v0}};
+        q[2] = {{x1, y1}, c, {u1, v1}};
+        q[3] = {{x0, y1}, c, {u0, v1}};
+    }
+    endQuads(list, count);
+    drawLine(list, 0, logicalH * 0.8f, static_cast<float>(logicalW), logicalH * 0.8f, {255, 255, 255, 255});
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "render.h"
+#include "raster.h"
+#include <vector>
+
+// Frames each candidate renders while probing, after a short warm-up
+const int BACKEND_PROBE_WARMUP = 5;
+const int BACKEND_PROBE_FRAMES = 30;
+
+//enum
+enum class BackendType {
+    AUTO,       // Probe the real backends at startup and keep the fastest
+    RENDERER,   // SDL_Renderer, hardware accelerated
+    SOFTWARE,   // SDL_Renderer, software
+    SURFACE,    // CPU rasteriser into the window surface
+    NONE,       // Counts commands and draws nothing
+    COUNT
+};
+
+//structure
+// Where a draw list goes. One of these owns everything tied to the window:
+// the renderer and its atlas and scene textures, or the CPU canvas.
+struct RenderBackend {
+    BackendType type;
+    SDL_Window* window;
+
+    // RENDERER / SOFTWARE
+    SDL_Renderer* renderer;
+    SDL_Texture* atlasTexture;
+    SDL_Texture* sceneTexture;
+
+    // SURFACE: drawing goes to canvas, which is the window surface itself
+    // unless a scene target is in use or the window's format isn't 32-bit xRGB
+    SDL_Surface* windowSurface;
+    SDL_Surface* canvas;
+    bool ownsCanvas;
+    RasterSource source;      // Premultiplied copy of the atlas
+    JobSystem* jobs;          // Tiles are rasterised in parallel when set
+    RasterBins bins;
+    // Dirty-rect mode: the canvas persists between frames and only damage
+    // (window-space rects redrawn this frame) is redrawn and presented.
+    // partial is false after a full redraw.
+    bool dirtyRects;
+    bool partial;
+    std::vector<SDL_Rect> damage;
+    float damageFraction;     // Share of the canvas redrawn last frame
+
+    // Totals since init. Every backend counts frames and commands; the null
+    // backend also counts by type, which is all it does.
+    Uint64 frames;
+    Uint64 commands;
+    Uint64 sprites;
+    Uint64 quads;
+    Uint64 lines;
+};
+
+// A cached offscreen layer (HUD, overlays). It is redrawn from its own draw
+// list only when its contents change and composited over every frame.
+// Pixels are premultiplied, so a partly transparent layer blends once.
+struct RenderLayer {
+    int width, height;        // Layer pixels, which are logical pixels
+    SDL_Texture* texture;     // RENDERER / SOFTWARE
+    RasterSource pixels;      // SURFACE: owned ARGB8888 surface
+};
+
+//function definaction
+const char* backendName(BackendType type);
+bool parseBackendType(const char* name, BackendType& type);
+// Create the backend on window. A scene target the backend can't provide is
+// reset to width 0 (draw straight to the window). AUTO is not accepted here;
+// see probeBackend.
+bool initBackend(RenderBackend& backend, BackendType type, SDL_Window* window, const Atlas& atlas,
+                 SceneTarget& scene, JobSystem* jobs);
+void destroyBackend(RenderBackend& backend);
+// Turn dirty-rect rendering on or off. Only the surface backend drawing at
+// window resolution supports it; returns whether it is on.
+bool setBackendDirtyRects(RenderBackend& backend, bool enabled, const SceneTarget& scene);
+// The window lost its contents (exposed, resized, restored): redraw it all
+void backendInvalidate(RenderBackend& backend);
+// Try RENDERER, then SOFTWARE, then SURFACE until one initialises
+bool initBackendFallback(RenderBackend& backend, BackendType first, SDL_Window* window, const Atlas& atlas,
+                         SceneTarget& scene, JobSystem* jobs);
+// Time a synthetic scene on each real backend and return the fastest by
+// render plus present time
+BackendType probeBackend(SDL_Window* window, const Atlas& atlas, const SceneTarget& scene,
+                         JobSystem* jobs, int logicalW, int logicalH);
+
+// Draw a logicalW x logicalH draw list (without presenting)
+void backendRender(RenderBackend& backend, const DrawList& list, const SceneTarget& scene,
+                   int logicalW, int logicalH);
+// Push queued work to the driver so render timings include it
+void backendFlush(RenderBackend& backend);
+void backendPresent(RenderBackend& backend);
+
+// Layers belong to the backend they were made on; destroy them first
+bool initLayer(RenderBackend& backend, RenderLayer& layer, int width, int height);
+void destroyLayer(RenderLayer& layer);
+// Redraw the layer from list, cleared to list's clear colour (usually
+// transparent). Do this before backendRender so the renderer backends
+// don't switch targets mid-frame.
+void backendRenderLayer(RenderBackend& backend, RenderLayer& layer, const DrawList& list);
+// Draw the layer over the frame at dst, in logical coordinates. Call after
+// backendRender and before backendPresent.
+void backendCompositeLayer(RenderBackend& backend, const RenderLayer& layer, const SDL_FRect& dst,
+                           int logicalW, int logicalH);
+
+// Fill list with count atlas quads scattered over the screen plus a few
+// sprites, for probing and benchmarks
+void buildSyntheticDrawList(DrawList& list, const Atlas& atlas, int count, int logicalW, int logicalH);
@@ -0,0 +1,384 @@
+#include "bench.h"
+#include "backend.h"
+#include "jobs.h"
+#include "log.h"
+#include "random.h"
+#include "telemetry.h"
+
+#include "SDL2/SDL.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const int BENCH_ELEMENTS = 1 << 20;
+const int BENCH_REPEATS = 10;
+const int BENCH_RENDER_FRAMES = 60;
+const int BENCH_RENDER_QUADS[] = {1000, 10000, 50000};
+const int BENCH_BLIT_ROWS = 20000;      // Random rows compared per kernel
+const int BENCH_BLIT_FRAMES = 30;
+const int BENCH_RASTER_W = 1920;
+const int BENCH_RASTER_H = 1080;
+const int BENCH_RASTER_QUADS = 50000;
+const int BENCH_RASTER_MAX_THREADS = 16;
+const int BENCH_TEXT_FRAMES = 10000;
+
+// Stand-in for an entity update: a few dozen flops per element
+struct BenchData {
+    std::vector<float> x, v;
+    std::vector<double> chunkSums;
+    int grain;
+};
+
+static void benchKernel(void* data, int begin, int end) {
+    BenchData& d = *static_cast<BenchData*>(data);
+    double sum = 0;
+    for (int i = begin; i < end; i++) {
+        float x = d.x[i], v = d.v[i];
+        for (int k = 0; k < 16; k++) {
+            v += -0.01f * x + 0.001f * std::sin(x);
+            x += v * 0.016f;
+        }
+        d.x[i] = x;
+        d.v[i] = v;
+        sum += x;
+    }
+    d.chunkSums[begin / d.grain] = sum;
+}
+
+void runJobBenchmark(int maxThreads) {
+    if (maxThreads <= 0) maxThreads = SDL_GetCPUCount();
+
+    std::cout << "Job system scaling, " << BENCH_ELEMENTS << " elements, best of "
+              << BENCH_REPEATS << "\n";
+    std::cout << "threads\tms\tspeedup\tefficiency\tchecksum\n";
+
+    double baseline = 0;
+    // 1, 2, 4, ... then maxThreads
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        // Deterministic mode so the checksum must match across thread counts
+        JobSystem system;
+        if (!initJobSystem(system, threads, true)) return;
+
+        BenchData data;
+        data.grain = jobGrain(system, BENCH_ELEMENTS, 0);
+        data.chunkSums.assign((BENCH_ELEMENTS + data.grain - 1) / data.grain, 0);
+
+        double best = 1e30;
+        double checksum = 0;
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            data.x.assign(BENCH_ELEMENTS, 1.0f);
+            data.v.assign(BENCH_ELEMENTS, 0.0f);
+            for (int i = 0; i < BENCH_ELEMENTS; i++) data.x[i] = static_cast<float>(i % 1000);
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            parallelFor(system, BENCH_ELEMENTS, data.grain, benchKernel, &data);
+            best = std::min(best, elapsedMs(start));
+
+            // Reduce in chunk order
+            checksum = 0;
+            for (double s : data.chunkSums) checksum += s;
+        }
+        shutdownJobSystem(system);
+
+        if (threads == 1) baseline = best;
+        std::cout << threads << "\t" << best << "\t" << baseline / best << "\t"
+                  << baseline / best / threads << "\t" << checksum << "\n";
+        if (threads == maxThreads) break;
+    }
+    std::cout << std::flush;
+}
+
+void runRenderBenchmark(SDL_Window* window, const Atlas& atlas, JobSystem& jobs, int logicalW, int logicalH) {
+    const BackendType backends[] = {
+        BackendType::NONE, BackendType::RENDERER, BackendType::SOFTWARE, BackendType::SURFACE
+    };
+    DrawList list;
+    initDrawList(list);
+
+    // Render is the CPU side (flushed to the driver); present is whatever
+    // waiting and copying the backend does to get pixels on screen. The null
+    // backend is the floor: walking the list without drawing it.
+    std::cout << "Render backends, " << logicalW << "x" << logicalH << ", mean of "
+              << BENCH_RENDER_FRAMES << " frames\n";
+    std::cout << "backend\tquads\trender_ms\tpresent_ms\n";
+    for (int quads : BENCH_RENDER_QUADS) {
+        buildSyntheticDrawList(list, atlas, quads, logicalW, logicalH);
+        for (BackendType type : backends) {
+            RenderBackend backend;
+            SceneTarget scene = {0, 0, 0, 0, false};
+            if (!initBackend(backend, type, window, atlas, scene, &jobs)) continue;
+
+            double renderMs = 0, presentMs = 0;
+            for (int f = 0; f < BENCH_RENDER_FRAMES; f++) {
+                Uint64 start = SDL_GetPerformanceCounter();
+                backendRender(backend, list, scene, logicalW, logicalH);
+                backendFlush(backend);
+                renderMs += elapsedMs(start);
+                start = SDL_GetPerformanceCounter();
+                backendPresent(backend);
+                presentMs += elapsedMs(start);
+                SDL_PumpEvents();
+            }
+            destroyBackend(backend);
+
+            std::cout << backendName(type) << "\t" << quads << "\t" << renderMs / BENCH_RENDER_FRAMES << "\t"
+                      << presentMs / BENCH_RENDER_FRAMES << "\n";
+        }
+    }
+    std::cout << std::flush;
+}
+
+// Run one row kernel and the scalar reference on the same random input
+// and count differing pixels
+static int compareKernel(RowKernel kernel, RowKernel reference, bool premultiplied, Uint32& rng) {
+    const int texels = 256;
+    Uint32 src[texels], dst[80], expect[80];
+    int bad = 0;
+    for (int r = 0; r < BENCH_BLIT_ROWS; r++) {
+        // Fully transparent and opaque texels often, to hit both edges
+        for (int i = 0; i < texels; i++) {
+            Uint32 a = nextRandom(rng) % 4 == 0 ? 0 : (nextRandom(rng) % 4 == 0 ? 255 : nextRandom(rng) & 0xff);
+            src[i] = (a << 24) | (nextRandom(rng) & 0xffffff);
+            if (premultiplied) {
+                // Valid premultiplied texels never have colour above alpha
+                Uint32 c = src[i];
+                src[i] = (a << 24) | ((((c >> 16) & 0xff) * a / 255) << 16) |
+                         ((((c >> 8) & 0xff) * a / 255) << 8) | ((c & 0xff) * a / 255);
+            }
+        }
+        int count = 1 + nextRandom(rng) % 79;
+        for (int i = 0; i < count; i++) expect[i] = dst[i] = nextRandom(rng);
+
+        // 1:1, mirrored 1:1, and arbitrary scales either way
+        Sint32 du;
+        switch (nextRandom(rng) % 4) {
+        case 0: du = 1 << RASTER_FRAC_BITS; break;
+        case 1: du = -(1 << RASTER_FRAC_BITS); break;
+        default: du = static_cast<Sint32>(nextRandom(rng) % (3 << RASTER_FRAC_BITS)); break;
+        }
+        if (nextRandom(rng) & 1) du = -du;
+        Sint64 span = static_cast<Sint64>(count - 1) * (du < 0 ? -du : du);
+        Sint64 room = (static_cast<Sint64>(texels) << RASTER_FRAC_BITS) - span;
+        if (room <= 0) {
+            du = 0;
+            room = static_cast<Sint64>(texels) << RASTER_FRAC_BITS;
+        }
+        Sint32 u = static_cast<Sint32>(nextRandom(rng) % room);
+        if (du < 0) u += static_cast<Sint32>(span);
+        Uint32 mod = nextRandom(rng) & 1 ? 0xffffffffu : nextRandom(rng);
+
+        reference(expect, src, count, u, du, mod);
+        kernel(dst, src, count, u, du, mod);
+        for (int i = 0; i < count; i++) bad += dst[i] != expect[i];
+    }
+    return bad;
+}
+
+void runBlitBenchmark(const Atlas& atlas, int logicalW, int logicalH) {
+    // Pixel-exact check of every SIMD kernel against its scalar reference
+    std::cout << "Blit kernels vs scalar reference, " << BENCH_BLIT_ROWS << " random rows each\n";
+    for (int isa = static_cast<int>(RasterIsa::SSE2); isa < static_cast<int>(RasterIsa::COUNT); isa++) {
+        for (int premultiplied = 0; premultiplied < 2; premultiplied++) {
+            RowKernel kernel = rowKernel(static_cast<RasterIsa>(isa), premultiplied != 0);
+            std::cout << rasterIsaName(static_cast<RasterIsa>(isa))
+                      << (premultiplied ? " premultiplied\t" : " straight\t");
+            if (!kernel) {
+                std::cout << "unsupported\n";
+                continue;
+            }
+            Uint32 rng = 0x9e3779b9u;
+            int bad = compareKernel(kernel, rowKernel(RasterIsa::SCALAR, premultiplied != 0), premultiplied != 0, rng);
+            std::cout << (bad ? "MISMATCH " : "exact ") << bad << "\n";
+        }
+    }
+
+    // Scaled, half of them mirrored, cycling through the atlas
+    DrawList list;
+    initDrawList(list);
+    clearDrawList(list, {0, 0, 0, 255});
+    Uint32 rng = 0x2545f491u;
+    for (int i = 0; i < DRAW_MAX_COMMANDS; i++) {
+        const SDL_Rect& r = atlas.regions[i % atlas.regions.size()].rect;
+        if (r.w == 0) continue;
+        SDL_FRect dst = {randomRange(rng, -r.w, logicalW), randomRange(rng, -r.h, logicalH), r.w * 1.5f, r.h * 1.5f};
+        drawSprite(list, r, dst, (i & 1) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+    }
+    int sprites = static_cast<int>(list.commands.size());
+
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, logicalW, logicalH, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!target) {
+        LOG_ERROR(LogCategory::PERF, "Failed to create blit target: {}", SDL_GetError());
+        return;
+    }
+    std::cout << sprites << " scaled sprites into " << logicalW << "x" << logicalH << ", mean of "
+              << BENCH_BLIT_FRAMES << " frames\n";
+    std::cout << "blitter\tms\tMsprites/s\n";
+
+    // SDL's own software renderer drawing the same list
+    SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(target);
+    SDL_Texture* texture = renderer ? SDL_CreateTextureFromSurface(renderer, atlas.surface) : NULL;
+    if (texture) {
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int f = 0; f < BENCH_BLIT_FRAMES; f++) {
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            for (const DrawCommand& cmd : list.commands) {
+                SDL_RenderCopyExF(renderer, texture, &cmd.src, &cmd.dst, 0, NULL, cmd.flip);
+            }
+            SDL_RenderFlush(renderer);
+        }
+        double ms = elapsedMs(start) / BENCH_BLIT_FRAMES;
+        std::cout << "sdl-software\t" << ms << "\t" << sprites / ms / 1000.0 << "\n";
+    }
+    if (texture) SDL_DestroyTexture(texture);
+    if (renderer) SDL_DestroyRenderer(renderer);
+
+    // Ours, per instruction set and texel format
+    RasterIsa saved = rasterIsa();
+    SDL_Rect clip = {0, 0, logicalW, logicalH};
+    for (int premultiplied = 0; premultiplied < 2; premultiplied++) {
+        RasterSource source;
+        if (!initRasterSource(source, atlas, premultiplied != 0)) break;
+        for (int isa = 0; isa < static_cast<int>(RasterIsa::COUNT); isa++) {
+            if (!setRasterIsa(static_cast<RasterIsa>(isa))) continue;
+            Uint64 start = SDL_GetPerformanceCounter();
+            for (int f = 0; f < BENCH_BLIT_FRAMES; f++) {
+                rasterDrawList(target, clip, source, list, 1.0f, 1.0f);
+            }
+            double ms = elapsedMs(start) / BENCH_BLIT_FRAMES;
+            std::cout << rasterIsaName(static_cast<RasterIsa>(isa))
+                      << (premultiplied ? "-premultiplied\t" : "-straight\t") << ms << "\t"
+                      << sprites / ms / 1000.0 << "\n";
+        }
+        destroyRasterSource(source);
+    }
+    setRasterIsa(saved);
+    SDL_FreeSurface(target);
+    std::cout << std::flush;
+}
+
+void runRasterBenchmark(const Atlas& atlas, int maxThreads, int logicalW, int logicalH) {
+    if (maxThreads <= 0) maxThreads = std::min(SDL_GetCPUCount(), BENCH_RASTER_MAX_THREADS);
+
+    DrawList list;
+    initDrawList(list);
+    buildSyntheticDrawList(list, atlas, BENCH_RASTER_QUADS, logicalW, logicalH);
+    RasterSource source;
+    if (!initRasterSource(source, atlas, true)) return;
+    SDL_Surface* reference = SDL_CreateRGBSurfaceWithFormat(0, BENCH_RASTER_W, BENCH_RASTER_H, 32,
+                                                            SDL_PIXELFORMAT_ARGB8888);
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, BENCH_RASTER_W, BENCH_RASTER_H, 32,
+                                                         SDL_PIXELFORMAT_ARGB8888);
+    if (!reference || !target) {
+        LOG_ERROR(LogCategory::PERF, "Failed to create raster targets: {}", SDL_GetError());
+        if (reference) SDL_FreeSurface(reference);
+        destroyRasterSource(source);
+        return;
+    }
+
+    SDL_Rect clip = {0, 0, BENCH_RASTER_W, BENCH_RASTER_H};
+    float scaleX = static_cast<float>(BENCH_RASTER_W) / logicalW;
+    float scaleY = static_cast<float>(BENCH_RASTER_H) / logicalH;
+    rasterDrawList(reference, clip, source, list, scaleX, scaleY);
+
+    std::cout << "Tiled rasterisation, " << BENCH_RASTER_QUADS << " quads at " << BENCH_RASTER_W << "x"
+              << BENCH_RASTER_H << ", " << rasterIsaName(rasterIsa()) << " kernels, best of "
+              << BENCH_REPEATS << "\n";
+    std::cout << "threads\tms\tspeedup\tefficiency\tmatches single-threaded\n";
+
+    RasterBins bins;
+    initRasterBins(bins);
+    double baseline = 0;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        JobSystem system;
+        if (!initJobSystem(system, threads, false)) break;
+
+        double best = 1e30;
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            SDL_FillRect(target, NULL, 0x12345678);
+            Uint64 start = SDL_GetPerformanceCounter();
+            rasterDrawListTiled(target, clip, source, list, scaleX, scaleY, bins, system);
+            best = std::min(best, elapsedMs(start));
+        }
+        shutdownJobSystem(system);
+
+        bool same = true;
+        for (int y = 0; y < BENCH_RASTER_H && same; y++) {
+            same = memcmp(static_cast<Uint8*>(reference->pixels) + y * reference->pitch,
+                          static_cast<Uint8*>(target->pixels) + y * target->pitch, BENCH_RASTER_W * 4) == 0;
+        }
+
+        if (threads == 1) baseline = best;
+        std::cout << threads << "\t" << best << "\t" << baseline / best << "\t"
+                  << baseline / best / threads << "\t" << (same ? "yes" : "NO") << "\n";
+        if (threads == maxThreads) break;
+    }
+
+    SDL_FreeSurface(target);
+    SDL_FreeSurface(reference);
+    destroyRasterSource(source);
+    std::cout << std::flush;
+}
+
+// One frame of a stats overlay: a few lines change every frame, the labels
+// and most values don't
+static int drawTextOverlay(DrawList& list, TextCache& cache, const Font& font, const Atlas& atlas, int frame) {
+    static const char* const labels[] = {
+        "Backend: surface (AVX2 kernels, 4 threads)",
+        "Scene: 640x480, dynamic resolution off",
+        "Phases: input / update / render / present",
+        "Keys: A/D move, Space jump, LCtrl crouch, E attack",
+        "Esc quits",
+    };
+    char line[TEXT_MAX_LENGTH];
+    int chars = 0;
+    float y = 4;
+    snprintf(line, sizeof(line), "Frame %d  %.2f ms  %.1f fps", frame, 16.0 + (frame % 7) * 0.13,
+             1000.0 / (16.0 + (frame % 7) * 0.13));
+    drawText(list, cache, font, atlas, line, 4, y, 1, {255, 255, 255, 255});
+    chars += static_cast<int>(strlen(line));
+    y += FONT_LINE;
+    snprintf(line, sizeof(line), "Draw calls %d  sprites %d  quads %d", 12 + frame % 3, 1, 4000 + frame % 50);
+    drawText(list, cache, font, atlas, line, 4, y, 1, {255, 255, 255, 255});
+    chars += static_cast<int>(strlen(line));
+    y += FONT_LINE;
+    snprintf(line, sizeof(line), "Projectiles %d  particles %d", 40 + frame % 11, 900 + frame % 97);
+    drawText(list, cache, font, atlas, line, 4, y, 1, {255, 255, 255, 255});
+    chars += static_cast<int>(strlen(line));
+    y += FONT_LINE;
+    for (const char* label : labels) {
+        drawText(list, cache, font, atlas, label, 4, y, 1, {200, 200, 200, 255});
+        chars += static_cast<int>(strlen(label));
+        y += FONT_LINE;
+    }
+    return chars;
+}
+
+void runTextBenchmark(const Font& font, const Atlas& atlas) {
+    DrawList list;
+    initDrawList(list);
+    TextCache cache;
+    initTextCache(cache);
+
+    std::cout << "Text overlay, " << BENCH_TEXT_FRAMES << " frames\n";
+    std::cout << "layouts\tchars/frame\tus/frame\thit rate\n";
+    for (int cached = 1; cached >= 0; cached--) {
+        clearTextCache(cache);
+        int chars = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < BENCH_TEXT_FRAMES; frame++) {
+            if (!cached) clearTextCache(cache);
+            clearDrawList(list, {0, 0, 0, 0});
+            chars = drawTextOverlay(list, cache, font, atlas, frame);
+        }
+        double us = elapsedMs(start) * 1000.0 / BENCH_TEXT_FRAMES;
+        double hitRate = static_cast<double>(cache.hits) / std::max<Uint64>(1, cache.hits + cache.misses);
+        std::cout << (cached ? "cached" : "rebuilt") << "\t" << chars << "\t" << us << "\t"
+                  << (cached ? hitRate : 0.0) << "\n";
+    }
+    std::cout << std::flush;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "jobs.h"
+#include "text.h"
+
+//function definaction
+// Scaling of a synthetic per-element workload from 1 to maxThreads workers
+void runJobBenchmark(int maxThreads);
+// Render and present cost of every backend on synthetic scenes of growing
+// size, drawn into window
+void runRenderBenchmark(SDL_Window* window, const Atlas& atlas, JobSystem& jobs, int logicalW, int logicalH);
+// Check the SIMD blit kernels pixel-exact against the scalar ones, then
+// time sprite blits against SDL's software renderer
+void runBlitBenchmark(const Atlas& atlas, int logicalW, int logicalH);
+// Tiled CPU rasterisation of a synthetic 1080p frame from 1 to maxThreads
+// workers (0: up to 16), checked identical to the single-threaded result
+void runRasterBenchmark(const Atlas& atlas, int maxThreads, int logicalW, int logicalH);
+// Lay out and batch a frame-stats overlay of a few hundred characters per
+// frame, with the layout cache and with it cleared every frame
+void runTextBenchmark(const Font& font, const Atlas& atlas);
@@ -0,0 +1,51 @@
+#include "camera.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Dead zone as a fraction of the view
+const float CAMERA_DEAD_ZONE_X = 0.3f;
+const float CAMERA_DEAD_ZONE_Y = 0.4f;
+
+static void clampToWorld(Camera& camera) {
+    camera.x = std::max(0.0f, std::min(camera.x, camera.worldW - camera.viewW));
+    camera.y = std::max(0.0f, std::min(camera.y, camera.worldH - camera.viewH));
+    camera.snapX = std::floor(camera.x);
+    camera.snapY = std::floor(camera.y);
+}
+
+void initCamera(Camera& camera, float viewW, float viewH, float worldW, float worldH) {
+    camera.x = 0;
+    camera.y = 0;
+    camera.snapX = 0;
+    camera.snapY = 0;
+    camera.viewW = viewW;
+    camera.viewH = viewH;
+    camera.deadZoneW = viewW * CAMERA_DEAD_ZONE_X;
+    camera.deadZoneH = viewH * CAMERA_DEAD_ZONE_Y;
+    camera.worldW = std::max(worldW, viewW);
+    camera.worldH = std::max(worldH, viewH);
+}
+
+void cameraFollow(Camera& camera, float x, float y, float w, float h) {
+    float zoneX = camera.x + (camera.viewW - camera.deadZoneW) * 0.5f;
+    float zoneY = camera.y + (camera.viewH - camera.deadZoneH) * 0.5f;
+
+    if (x < zoneX) camera.x -= zoneX - x;
+    else if (x + w > zoneX + camera.deadZoneW) camera.x += x + w - (zoneX + camera.deadZoneW);
+    if (y < zoneY) camera.y -= zoneY - y;
+    else if (y + h > zoneY + camera.deadZoneH) camera.y += y + h - (zoneY + camera.deadZoneH);
+
+    clampToWorld(camera);
+}
+
+void cameraCenter(Camera& camera, float x, float y, float w, float h) {
+    camera.x = x + w * 0.5f - camera.viewW * 0.5f;
+    camera.y = y + h * 0.5f - camera.viewH * 0.5f;
+    clampToWorld(camera);
+}
+
+bool cameraVisible(const Camera& camera, float minX, float minY, float maxX, float maxY) {
+    return maxX > camera.x && minX < camera.x + camera.viewW &&
+           maxY > camera.y && minY < camera.y + camera.viewH;
+}
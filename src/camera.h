@@ -0,0 +1,31 @@
+#pragma once
+#include "SDL2/SDL.h"
+
+//structure
+// Top-left of the view in world space. The target is kept inside a dead
+// zone centred in the view; the view never leaves the world.
+struct Camera {
+    float x, y;
+    float snapX, snapY;       // x, y floored to whole pixels
+    float viewW, viewH;
+    float deadZoneW, deadZoneH;
+    float worldW, worldH;
+};
+
+//function definaction
+void initCamera(Camera& camera, float viewW, float viewH, float worldW, float worldH);
+// Scroll just enough to keep the target box inside the dead zone
+void cameraFollow(Camera& camera, float x, float y, float w, float h);
+// Centre on a box immediately, e.g. on spawn
+void cameraCenter(Camera& camera, float x, float y, float w, float h);
+// Whether a world-space box overlaps the view
+bool cameraVisible(const Camera& camera, float minX, float minY, float maxX, float maxY);
+
+// World to screen; the camera is snapped to whole pixels so sprites don't shimmer
+inline float cameraScreenX(const Camera& camera, float x) {
+    return x - camera.snapX;
+}
+
+inline float cameraScreenY(const Camera& camera, float y) {
+    return y - camera.snapY;
+}
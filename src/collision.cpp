@@ -0,0 +1,447 @@
+#include "collision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Stand-in for 1/0 so slab tests never compute 0 * inf
+const float INV_ZERO = 1e30f;
+
+// A ray or a swept box reduced to a ray against boxes grown by (ex, ey)
+struct SlabQuery {
+    float ox, oy;
+    float invDx, invDy;
+    float ex, ey;
+    float maxT;
+};
+
+void initCollisionWorld(CollisionWorld& world) {
+    world.minX.clear();
+    world.minY.clear();
+    world.maxX.clear();
+    world.maxY.clear();
+    world.layers.clear();
+    world.cellSize = BROADPHASE_CELL_SIZE;
+    world.originX = 0;
+    world.originY = 0;
+    world.gridW = 0;
+    world.gridH = 0;
+    world.cellStart.assign(1, 0);
+    world.cellItems.clear();
+    world.stamps.clear();
+    world.stampValue = 0;
+    world.candidates.clear();
+}
+
+int addCollider(CollisionWorld& world, const AABB& box, uint32_t layer) {
+    world.minX.push_back(box.minX);
+    world.minY.push_back(box.minY);
+    world.maxX.push_back(box.maxX);
+    world.maxY.push_back(box.maxY);
+    world.layers.push_back(layer);
+    world.stamps.push_back(0);
+    world.candidates.reserve(world.layers.size());
+    return static_cast<int>(world.layers.size()) - 1;
+}
+
+void setCollider(CollisionWorld& world, int id, const AABB& box) {
+    world.minX[id] = box.minX;
+    world.minY[id] = box.minY;
+    world.maxX[id] = box.maxX;
+    world.maxY[id] = box.maxY;
+}
+
+// Clamp a box to the grid; false when it lies entirely outside or has a NaN
+// bound. Bounds are clamped to [-1, grid size] before the cast to int, so
+// huge or infinite boxes are safe.
+static bool cellRange(const CollisionWorld& world, float minX, float minY, float maxX, float maxY,
+                      int& x0, int& y0, int& x1, int& y1) {
+    if (world.gridW == 0) return false;
+
+    float inv = 1.0f / world.cellSize;
+    float fx0 = std::floor((minX - world.originX) * inv);
+    float fy0 = std::floor((minY - world.originY) * inv);
+    float fx1 = std::floor((maxX - world.originX) * inv);
+    float fy1 = std::floor((maxY - world.originY) * inv);
+    if (std::isnan(fx0) || std::isnan(fy0) || std::isnan(fx1) || std::isnan(fy1)) return false;
+    float w = static_cast<float>(world.gridW), h = static_cast<float>(world.gridH);
+    fx0 = std::min(std::max(fx0, -1.0f), w);
+    fy0 = std::min(std::max(fy0, -1.0f), h);
+    fx1 = std::min(std::max(fx1, -1.0f), w);
+    fy1 = std::min(std::max(fy1, -1.0f), h);
+    if (fx1 < 0 || fy1 < 0 || fx0 >= w || fy0 >= h) return false;
+
+    x0 = std::max(0, static_cast<int>(fx0));
+    y0 = std::max(0, static_cast<int>(fy0));
+    x1 = std::min(world.gridW - 1, static_cast<int>(fx1));
+    y1 = std::min(world.gridH - 1, static_cast<int>(fy1));
+    return true;
+}
+
+void buildBroadPhase(CollisionWorld& world) {
+    int n = static_cast<int>(world.layers.size());
+    if (n == 0) {
+        world.gridW = 0;
+        world.gridH = 0;
+        world.cellStart.assign(1, 0);
+        world.cellItems.clear();
+        return;
+    }
+
+    float bx0 = world.minX[0], by0 = world.minY[0];
+    float bx1 = world.maxX[0], by1 = world.maxY[0];
+    for (int i = 1; i < n; i++) {
+        bx0 = std::min(bx0, world.minX[i]);
+        by0 = std::min(by0, world.minY[i]);
+        bx1 = std::max(bx1, world.maxX[i]);
+        by1 = std::max(by1, world.maxY[i]);
+    }
+
+    world.cellSize = BROADPHASE_CELL_SIZE;
+    while ((bx1 - bx0) / world.cellSize >= BROADPHASE_MAX_CELLS ||
+           (by1 - by0) / world.cellSize >= BROADPHASE_MAX_CELLS) {
+        world.cellSize *= 2;
+    }
+    world.originX = bx0;
+    world.originY = by0;
+    world.gridW = static_cast<int>((bx1 - bx0) / world.cellSize) + 1;
+    world.gridH = static_cast<int>((by1 - by0) / world.cellSize) + 1;
+
+    // Counting sort: count per cell, turn counts into end offsets, then fill
+    // backwards so cellStart[c] ends up as the start of cell c
+    int cells = world.gridW * world.gridH;
+    world.cellStart.assign(cells + 1, 0);
+    for (int i = 0; i < n; i++) {
+        int x0, y0, x1, y1;
+        cellRange(world, world.minX[i], world.minY[i], world.maxX[i], world.maxY[i], x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                world.cellStart[y * world.gridW + x]++;
+    }
+    int total = 0;
+    for (int c = 0; c < cells; c++) {
+        total += world.cellStart[c];
+        world.cellStart[c] = total;
+    }
+    world.cellStart[cells] = total;
+    world.cellItems.resize(total);
+    for (int i = 0; i < n; i++) {
+        int x0, y0, x1, y1;
+        cellRange(world, world.minX[i], world.minY[i], world.maxX[i], world.maxY[i], x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                world.cellItems[--world.cellStart[y * world.gridW + x]] = i;
+    }
+}
+
+// Start a new query: colliders stamped with the new value are already candidates
+static void beginCandidates(CollisionWorld& world) {
+    world.candidates.clear();
+    if (++world.stampValue == 0) {
+        std::fill(world.stamps.begin(), world.stamps.end(), 0);
+        world.stampValue = 1;
+    }
+}
+
+static void addCellCandidates(CollisionWorld& world, int x, int y, uint32_t layerMask) {
+    int c = y * world.gridW + x;
+    for (int k = world.cellStart[c]; k < world.cellStart[c + 1]; k++) {
+        int id = world.cellItems[k];
+        if (world.stamps[id] == world.stampValue || !(world.layers[id] & layerMask)) continue;
+        world.stamps[id] = world.stampValue;
+        world.candidates.push_back(id);
+    }
+}
+
+// Collect unique colliders in the cells touched by a box into world.candidates
+static void gatherCandidates(CollisionWorld& world, float minX, float minY, float maxX, float maxY,
+                             uint32_t layerMask) {
+    beginCandidates(world);
+    int x0, y0, x1, y1;
+    if (!cellRange(world, minX, minY, maxX, maxY, x0, y0, x1, y1)) return;
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            addCellCandidates(world, x, y, layerMask);
+        }
+    }
+}
+
+// Grid cell holding v along one axis, clamped to [0, cells)
+static int cellAt(float v, float origin, float cellSize, int cells) {
+    float f = std::floor((v - origin) / cellSize);
+    if (!(f >= 0)) return 0;
+    return static_cast<int>(std::min(f, static_cast<float>(cells - 1)));
+}
+
+// Collect colliders in the cells a ray passes through, walking them in order
+// along its line (Amanatides-Woo), so a long diagonal ray visits about
+// gridW + gridH cells rather than its whole bounding box
+static void gatherRayCandidates(CollisionWorld& world, const Ray& r, uint32_t layerMask) {
+    beginCandidates(world);
+    if (world.gridW == 0 || !(r.maxT >= 0)) return;
+    if (std::isnan(r.x) || std::isnan(r.y) || std::isnan(r.dx) || std::isnan(r.dy)) return;
+
+    // Clip [0, maxT] to the grid's bounds
+    float gridX1 = world.originX + world.gridW * world.cellSize;
+    float gridY1 = world.originY + world.gridH * world.cellSize;
+    float t0 = 0, t1 = r.maxT;
+    if (r.dx == 0 && r.dy == 0) t1 = 0;
+    if (r.dx != 0) {
+        float ta = (world.originX - r.x) / r.dx, tb = (gridX1 - r.x) / r.dx;
+        t0 = std::max(t0, std::min(ta, tb));
+        t1 = std::min(t1, std::max(ta, tb));
+    } else if (!(r.x >= world.originX && r.x <= gridX1)) {
+        return;
+    }
+    if (r.dy != 0) {
+        float ta = (world.originY - r.y) / r.dy, tb = (gridY1 - r.y) / r.dy;
+        t0 = std::max(t0, std::min(ta, tb));
+        t1 = std::min(t1, std::max(ta, tb));
+    } else if (!(r.y >= world.originY && r.y <= gridY1)) {
+        return;
+    }
+    if (!(t0 <= t1)) return;
+
+    int x = cellAt(r.x + r.dx * t0, world.originX, world.cellSize, world.gridW);
+    int y = cellAt(r.y + r.dy * t0, world.originY, world.cellSize, world.gridH);
+    int endX = cellAt(r.x + r.dx * t1, world.originX, world.cellSize, world.gridW);
+    int endY = cellAt(r.y + r.dy * t1, world.originY, world.cellSize, world.gridH);
+    int stepX = r.dx > 0 ? 1 : (r.dx < 0 ? -1 : 0);
+    int stepY = r.dy > 0 ? 1 : (r.dy < 0 ? -1 : 0);
+    // t at which the ray crosses into the next column / row, and per cell
+    const float never = std::numeric_limits<float>::infinity();
+    float nextX = stepX ? (world.originX + (x + (stepX > 0)) * world.cellSize - r.x) / r.dx : never;
+    float nextY = stepY ? (world.originY + (y + (stepY > 0)) * world.cellSize - r.y) / r.dy : never;
+    float deltaX = stepX ? world.cellSize / std::fabs(r.dx) : never;
+    float deltaY = stepY ? world.cellSize / std::fabs(r.dy) : never;
+
+    // Each step moves one cell closer to the end, so this bound is never
+    // reached unless rounding walks past it
+    for (int steps = world.gridW + world.gridH; steps >= 0; steps--) {
+        addCellCandidates(world, x, y, layerMask);
+        if (x == endX && y == endY) break;
+        if (nextX < nextY) {
+            if (nextX > t1) break;
+            x += stepX;
+            nextX += deltaX;
+        } else {
+            if (nextY > t1) break;
+            y += stepY;
+            nextY += deltaY;
+        }
+        if (x < 0 || x >= world.gridW || y < 0 || y >= world.gridH) break;
+    }
+}
+
+// Slab test of one query against candidates; keeps the nearest hit
+static void slabCandidates(const CollisionWorld& world, const SlabQuery& q, int& bestId, float& bestT) {
+    const int* ids = world.candidates.data();
+    int count = static_cast<int>(world.candidates.size());
+#if defined(__SSE2__)
+    const __m128 ox = _mm_set1_ps(q.ox), oy = _mm_set1_ps(q.oy);
+    const __m128 invDx = _mm_set1_ps(q.invDx), invDy = _mm_set1_ps(q.invDy);
+    const __m128 ex = _mm_set1_ps(q.ex), ey = _mm_set1_ps(q.ey);
+    const __m128 maxT = _mm_set1_ps(q.maxT);
+    const __m128 zero = _mm_setzero_ps();
+    for (int i = 0; i < count; i += 4) {
+        // Pad the last group by repeating the final candidate
+        int a = ids[i];
+        int b = ids[std::min(i + 1, count - 1)];
+        int c = ids[std::min(i + 2, count - 1)];
+        int d = ids[std::min(i + 3, count - 1)];
+        __m128 bMinX = _mm_setr_ps(world.minX[a], world.minX[b], world.minX[c], world.minX[d]);
+        __m128 bMinY = _mm_setr_ps(world.minY[a], world.minY[b], world.minY[c], world.minY[d]);
+        __m128 bMaxX = _mm_setr_ps(world.maxX[a], world.maxX[b], world.maxX[c], world.maxX[d]);
+        __m128 bMaxY = _mm_setr_ps(world.maxY[a], world.maxY[b], world.maxY[c], world.maxY[d]);
+
+        __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(bMinX, ex), ox), invDx);
+        __m128 tx2 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(bMaxX, ex), ox), invDx);
+        __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(bMinY, ey), oy), invDy);
+        __m128 ty2 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(bMaxY, ey), oy), invDy);
+        __m128 tmin = _mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2));
+        __m128 tmax = _mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2));
+        tmin = _mm_max_ps(tmin, zero);
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(tmin, tmax), _mm_cmple_ps(tmin, maxT));
+
+        int mask = _mm_movemask_ps(hit);
+        if (!mask) continue;
+        float t[4];
+        _mm_storeu_ps(t, tmin);
+        int lane[4] = {a, b, c, d};
+        for (int l = 0; l < 4; l++) {
+            if ((mask & (1 << l)) && t[l] < bestT) {
+                bestT = t[l];
+                bestId = lane[l];
+            }
+        }
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        int id = ids[i];
+        float tx1 = (world.minX[id] - q.ex - q.ox) * q.invDx;
+        float tx2 = (world.maxX[id] + q.ex - q.ox) * q.invDx;
+        float ty1 = (world.minY[id] - q.ey - q.oy) * q.invDy;
+        float ty2 = (world.maxY[id] + q.ey - q.oy) * q.invDy;
+        float tmin = std::max(std::min(tx1, tx2), std::min(ty1, ty2));
+        float tmax = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+        tmin = std::max(tmin, 0.0f);
+        if (tmin <= tmax && tmin <= q.maxT && tmin < bestT) {
+            bestT = tmin;
+            bestId = id;
+        }
+    }
+#endif
+}
+
+// Resolve the nearest candidate and fill in the hit normal
+static bool slabQuery(CollisionWorld& world, const SlabQuery& q, float dx, float dy, RayHit& hit) {
+    int bestId = -1;
+    float bestT = q.maxT + 1.0f;
+    slabCandidates(world, q, bestId, bestT);
+
+    hit.collider = bestId;
+    hit.t = 0;
+    hit.nx = 0;
+    hit.ny = 0;
+    if (bestId < 0) return false;
+
+    hit.t = bestT;
+    if (bestT > 0) {
+        float tx1 = (world.minX[bestId] - q.ex - q.ox) * q.invDx;
+        float tx2 = (world.maxX[bestId] + q.ex - q.ox) * q.invDx;
+        float ty1 = (world.minY[bestId] - q.ey - q.oy) * q.invDy;
+        float ty2 = (world.maxY[bestId] + q.ey - q.oy) * q.invDy;
+        if (std::min(tx1, tx2) >= std::min(ty1, ty2)) {
+            hit.nx = dx > 0 ? -1.0f : 1.0f;
+        } else {
+            hit.ny = dy > 0 ? -1.0f : 1.0f;
+        }
+    }
+    return true;
+}
+
+static float safeInverse(float d) {
+    return d != 0 ? 1.0f / d : INV_ZERO;
+}
+
+int raycastBatch(CollisionWorld& world, const Ray* rays, int count,
+                 uint32_t layerMask, RayHit* hits) {
+    int hitCount = 0;
+    for (int i = 0; i < count; i++) {
+        const Ray& r = rays[i];
+        gatherRayCandidates(world, r, layerMask);
+
+        SlabQuery q = {r.x, r.y, safeInverse(r.dx), safeInverse(r.dy), 0, 0, r.maxT};
+        if (slabQuery(world, q, r.dx, r.dy, hits[i])) hitCount++;
+    }
+    return hitCount;
+}
+
+int sweepBatch(CollisionWorld& world, const Sweep* sweeps, int count,
+               uint32_t layerMask, RayHit* hits) {
+    int hitCount = 0;
+    for (int i = 0; i < count; i++) {
+        const Sweep& s = sweeps[i];
+        gatherCandidates(world,
+                         std::min(s.box.minX, s.box.minX + s.dx), std::min(s.box.minY, s.box.minY + s.dy),
+                         std::max(s.box.maxX, s.box.maxX + s.dx), std::max(s.box.maxY, s.box.maxY + s.dy),
+                         layerMask);
+
+        // Sweep the box centre against colliders grown by the box half extents
+        float ex = (s.box.maxX - s.box.minX) * 0.5f;
+        float ey = (s.box.maxY - s.box.minY) * 0.5f;
+        SlabQuery q = {s.box.minX + ex, s.box.minY + ey,
+                       safeInverse(s.dx), safeInverse(s.dy), ex, ey, 1.0f};
+        if (slabQuery(world, q, s.dx, s.dy, hits[i])) hitCount++;
+    }
+    return hitCount;
+}
+
+int overlapBatch(CollisionWorld& world, const AABB* boxes, int count,
+                 uint32_t layerMask, int* ids, int maxIds, int* idCounts, bool* truncated) {
+    int written = 0;
+    int hitCount = 0;
+    bool full = false;
+    for (int i = 0; i < count; i++) {
+        const AABB& q = boxes[i];
+        gatherCandidates(world, q.minX, q.minY, q.maxX, q.maxY, layerMask);
+
+        const int* cand = world.candidates.data();
+        int n = static_cast<int>(world.candidates.size());
+        int found = 0;
+#if defined(__SSE2__)
+        const __m128 qMinX = _mm_set1_ps(q.minX), qMinY = _mm_set1_ps(q.minY);
+        const __m128 qMaxX = _mm_set1_ps(q.maxX), qMaxY = _mm_set1_ps(q.maxY);
+        for (int k = 0; k < n; k += 4) {
+            int lanes = std::min(4, n - k);
+            int a = cand[k];
+            int b = cand[k + std::min(1, lanes - 1)];
+            int c = cand[k + std::min(2, lanes - 1)];
+            int d = cand[k + std::min(3, lanes - 1)];
+            __m128 bMinX = _mm_setr_ps(world.minX[a], world.minX[b], world.minX[c], world.minX[d]);
+            __m128 bMinY = _mm_setr_ps(world.minY[a], world.minY[b], world.minY[c], world.minY[d]);
+            __m128 bMaxX = _mm_setr_ps(world.maxX[a], world.maxX[b], world.maxX[c], world.maxX[d]);
+            __m128 bMaxY = _mm_setr_ps(world.maxY[a], world.maxY[b], world.maxY[c], world.maxY[d]);
+            __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(qMinX, bMaxX), _mm_cmpgt_ps(qMaxX, bMinX)),
+                                    _mm_and_ps(_mm_cmplt_ps(qMinY, bMaxY), _mm_cmpgt_ps(qMaxY, bMinY)));
+            // Padded lanes repeat the last id, so only the real lanes count
+            int mask = _mm_movemask_ps(hit) & ((1 << lanes) - 1);
+            for (int l = 0; l < lanes; l++) {
+                if (!(mask & (1 << l))) continue;
+                if (written == maxIds) {
+                    full = true;
+                    continue;
+                }
+                ids[written++] = cand[k + l];
+                found++;
+            }
+        }
+#else
+        for (int k = 0; k < n; k++) {
+            int id = cand[k];
+            if (q.minX < world.maxX[id] && q.maxX > world.minX[id] &&
+                q.minY < world.maxY[id] && q.maxY > world.minY[id]) {
+                if (written == maxIds) {
+                    full = true;
+                    continue;
+                }
+                ids[written++] = id;
+                found++;
+            }
+        }
+#endif
+        idCounts[i] = found;
+        if (found) hitCount++;
+    }
+    if (truncated) *truncated = full;
+    return hitCount;
+}
+
+int pointQueryBatch(const CollisionWorld& world, const float* xs, const float* ys, int count,
+                    uint32_t layerMask, int* hitIds) {
+    int hitCount = 0;
+    float inv = 1.0f / world.cellSize;
+    for (int i = 0; i < count; i++) {
+        hitIds[i] = -1;
+        float cx = (xs[i] - world.originX) * inv;
+        float cy = (ys[i] - world.originY) * inv;
+        if (cx < 0 || cy < 0 || cx >= world.gridW || cy >= world.gridH) continue;
+
+        // A point lies in exactly one cell, so there are no duplicates to skip
+        int c = static_cast<int>(cy) * world.gridW + static_cast<int>(cx);
+        for (int k = world.cellStart[c]; k < world.cellStart[c + 1]; k++) {
+            int id = world.cellItems[k];
+            if ((world.layers[id] & layerMask) &&
+                xs[i] >= world.minX[id] && xs[i] < world.maxX[id] &&
+                ys[i] >= world.minY[id] && ys[i] < world.maxY[id]) {
+                hitIds[i] = id;
+                hitCount++;
+                break;
+            }
+        }
+    }
+    return hitCount;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Collision layers (bitmask)
+const uint32_t LAYER_WORLD = 1u << 0;
+const uint32_t LAYER_PLAYER = 1u << 1;
+const uint32_t LAYER_ALL = 0xffffffffu;
+
+// Broad-phase grid cell size in pixels
+const float BROADPHASE_CELL_SIZE = 64.0f;
+// Upper bound on grid cells per axis; cells grow to fit larger worlds
+const int BROADPHASE_MAX_CELLS = 128;
+
+//structure
+struct AABB {
+    float minX, minY;
+    float maxX, maxY;
+};
+
+struct Ray {
+    float x, y;           // Origin
+    float dx, dy;         // Direction (need not be normalized)
+    float maxT;           // Hits are reported for t in [0, maxT]
+};
+
+struct Sweep {
+    AABB box;             // Box at t = 0
+    float dx, dy;         // Displacement over t in [0, 1]
+};
+
+struct RayHit {
+    int collider;         // -1 when nothing was hit
+    float t;
+    float nx, ny;         // Surface normal at the hit
+};
+
+// Colliders are kept in SoA form so the narrow-phase can test 4 at a time.
+// The broad-phase is a uniform grid rebuilt once per tick by buildBroadPhase;
+// every query in every batch until the next rebuild shares it.
+struct CollisionWorld {
+    std::vector<float> minX, minY, maxX, maxY;
+    std::vector<uint32_t> layers;
+
+    // Broad-phase grid (counting-sorted collider ids per cell)
+    float cellSize;
+    float originX, originY;
+    int gridW, gridH;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+
+    // Query scratch, sized with the collider count
+    std::vector<uint32_t> stamps;
+    uint32_t stampValue;
+    std::vector<int> candidates;
+};
+
+//function definaction
+void initCollisionWorld(CollisionWorld& world);
+int addCollider(CollisionWorld& world, const AABB& box, uint32_t layer);
+void setCollider(CollisionWorld& world, int id, const AABB& box);
+void buildBroadPhase(CollisionWorld& world);
+
+// Batched queries. Results go to caller-provided arrays, one entry per query
+// unless noted; the return value is the number of queries that hit.
+// Rays visit only the grid cells along their line; maxT may be infinite.
+int raycastBatch(CollisionWorld& world, const Ray* rays, int count,
+                 uint32_t layerMask, RayHit* hits);
+int sweepBatch(CollisionWorld& world, const Sweep* sweeps, int count,
+               uint32_t layerMask, RayHit* hits);
+// Writes overlapping collider ids for each box back to back into ids (at most
+// maxIds in total) and the number written for box i into idCounts[i]. Overlaps
+// past maxIds are left out and *truncated (if given) is set, so a full buffer
+// can be told from a complete result.
+int overlapBatch(CollisionWorld& world, const AABB* boxes, int count,
+                 uint32_t layerMask, int* ids, int maxIds, int* idCounts, bool* truncated);
+// First collider containing each point, or -1. Touches no shared scratch, so
+// disjoint ranges may run on different threads.
+int pointQueryBatch(const CollisionWorld& world, const float* xs, const float* ys, int count,
+                    uint32_t layerMask, int* hitIds);
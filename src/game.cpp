@@ -3,15 +3,14 @@
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_image.h"
 
-#include <iostream>
 bool initSDL(Game& game) {
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "SDL_Init failed: " << SDL_GetError() << std::endl;
+        LOG_ERROR(LogCategory::CORE, "SDL_Init failed: {}", SDL_GetError());
         return false;
     }
     
     if (IMG_Init(IMG_INIT_PNG) == 0) {
-        std::cerr << "IMG_Init failed: " << IMG_GetError() << std::endl;
+        LOG_ERROR(LogCategory::CORE, "IMG_Init failed: {}", IMG_GetError());
         SDL_Quit();
         return false;
     }
@@ -21,16 +20,7 @@ bool initSDL(Game& game) {
                                   SDL_WINDOWPOS_UNDEFINED,
                                   SCREEN_WIDTH, SCREEN_HEIGHT, 0);
     if (!game.window) {
-        std::cerr << "SDL_CreateWindow failed: " << SDL_GetError() << std::endl;
-        IMG_Quit();
-        SDL_Quit();
-        return false;
-    }
-    
-    game.renderer = SDL_CreateRenderer(game.window, -1, SDL_RENDERER_ACCELERATED);
-    if (!game.renderer) {
-        std::cerr << "SDL_CreateRenderer failed: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(game.window);
+        LOG_ERROR(LogCategory::CORE, "SDL_CreateWindow failed: {}", SDL_GetError());
         IMG_Quit();
         SDL_Quit();
         return false;
@@ -41,11 +31,55 @@ bool initSDL(Game& game) {
 
 // Load game resources
 bool loadResources(Game& game) {
-    game.playerTexture = IMG_LoadTexture(game.renderer, "assets/adventurer-Sheet.png");
-    if (!game.playerTexture) {
-        std::cerr << "Failed to load texture: " << IMG_GetError() << std::endl;
+    SDL_Surface* sheet = IMG_Load("assets/adventurer-Sheet.png");
+    if (!sheet) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to load sprite sheet: {}", IMG_GetError());
+        return false;
+    }
+
+    // Collision masks per sheet cell, at the size and facings we draw them
+    if (!buildSheetMasks(sheet, FRAME_WIDTH, FRAME_HEIGHT, PLAYER_WIDTH, PLAYER_HEIGHT, game.playerMasks)) {
+        SDL_FreeSurface(sheet);
+        return false;
+    }
+
+    // Trim every frame to its opaque pixels and pack them into the atlas
+    game.sheetColumns = sheet->w / FRAME_WIDTH;
+    if (!initAtlas(game.atlas, ATLAS_SIZE, ATLAS_SIZE) ||
+        !atlasAddSheet(game.atlas, sheet, FRAME_WIDTH, FRAME_HEIGHT, game.playerFrames)) {
+        SDL_FreeSurface(sheet);
         return false;
     }
+    SDL_FreeSurface(sheet);
+
+    // Projectile pool and its sprite
+    initProjectiles(game.projectiles);
+    game.projectiles.region = atlasAddDisc(game.atlas, 8, 0xffe080);
+
+    // Particle effects share one white disc tinted per emitter
+    initParticles(game.particles);
+    int particleRegion = atlasAddDisc(game.atlas, 8, 0xffffff);
+    EmitterParams dust = {
+        0, -1.5708f, 1.2f, 20.0f, 70.0f, 60.0f, 250.0f, 450.0f, 5.0f, 10.0f,
+        {200, 190, 170, 200}, {200, 190, 170, 0}, particleRegion
+    };
+    EmitterParams sparks = {
+        0, 0, 0.6f, 120.0f, 320.0f, 600.0f, 120.0f, 260.0f, 4.0f, 1.0f,
+        {255, 255, 200, 255}, {255, 120, 0, 0}, particleRegion
+    };
+    game.dustEmitter = createEmitter(game.particles, dust);
+    game.sparkEmitter = createEmitter(game.particles, sparks);
+
+    // Hearts and the stamina bar
+    if (!loadHud(game.hud, game.atlas)) return false;
+
+    // Bitmap font for debug text
+    if (!loadFont(game.font, game.atlas)) return false;
+    initTextCache(game.text);
+    if (!loadOverlay(game.overlay, game.atlas)) return false;
+
+    finalizeAtlas(game.atlas);
+    initDrawList(game.drawList);
 
     // Initialize animations
     // Format: {row, {frame1, frame2, ...}}
@@ -60,24 +94,50 @@ bool loadResources(Game& game) {
     return true;
 }
 
+// World-space bounds of the player
+static AABB playerBounds(const Player& p) {
+    return {p.x, p.y, p.x + p.width, p.y + p.height};
+}
+
 // Initialize game state
 void initGame(Game& game) {
-    game.player = {100, 100, 0, 0, false, 50, 50, AnimationState::IDLE, true};
+    game.player = {100, 100, 0, 0, false, PLAYER_WIDTH, PLAYER_HEIGHT, AnimationState::IDLE, true,
+                   PLAYER_MAX_HEALTH, PLAYER_MAX_HEALTH, PLAYER_MAX_STAMINA};
     game.groundY = 400;
     game.currentAnimIndex = 0;
     game.animFrame = 0;
     game.animTimer = 0;
+    game.hitCooldown = 0;
+    buildSolidMask(game.projectileMask, PROJECTILE_SIZE, PROJECTILE_SIZE);
+    initInput(game.input);
+
+    // Collision world: static ground plus the player's box
+    initCollisionWorld(game.world);
+    game.groundCollider = addCollider(game.world, {0, game.groundY, WORLD_WIDTH, WORLD_HEIGHT}, LAYER_WORLD);
+    game.playerCollider = addCollider(game.world, playerBounds(game.player), LAYER_PLAYER);
+    buildBroadPhase(game.world);
+
+    clearProjectiles(game.projectiles);
+    game.projectiles.boundsMinX = 0;
+    game.projectiles.boundsMinY = 0;
+    game.projectiles.boundsMaxX = WORLD_WIDTH;
+    game.projectiles.boundsMaxY = WORLD_HEIGHT;
+    clearParticles(game.particles);
+
+    initCamera(game.camera, SCREEN_WIDTH, SCREEN_HEIGHT, WORLD_WIDTH, WORLD_HEIGHT);
+    cameraCenter(game.camera, game.player.x, game.player.y, game.player.width, game.player.height);
 }
 
-// Handle keyboard input
-void handleInput(Game& game, const Uint8* keys) {
+// Apply this tick's actions to the player
+void handleInput(Game& game, const ActionState& input) {
+    PROFILE_SCOPE("handleInput");
     Player& p = game.player;
     
     // Reset movement flag
     bool moving = false;
     
     // Handle movement
-    if (keys[SDL_SCANCODE_D] && p.x < SCREEN_WIDTH - p.width) {
+    if (actionDown(input, Action::RIGHT) && p.x < WORLD_WIDTH - p.width) {
         p.x += PLAYER_SPEED;
         p.facingRight = true;
         moving = true;
@@ -85,7 +145,7 @@ void handleInput(Game& game, const Uint8* keys) {
             p.state = AnimationState::RUNNING;
         }
     }
-    if (keys[SDL_SCANCODE_A] && p.x > 0) {
+    if (actionDown(input, Action::LEFT) && p.x > 0) {
         p.x -= PLAYER_SPEED;
         p.facingRight = false;
         moving = true;
@@ -95,21 +155,35 @@ void handleInput(Game& game, const Uint8* keys) {
     }
     
     // Jumping
-    if (keys[SDL_SCANCODE_SPACE] && !p.isJumping && p.state != AnimationState::ATTACKING) {
+    if (actionDown(input, Action::JUMP) && !p.isJumping && p.state != AnimationState::ATTACKING) {
         p.vely = JUMP_FORCE;
         p.isJumping = true;
         p.state = AnimationState::JUMPING;
     }
     
     // Crouching
-    if (keys[SDL_SCANCODE_LCTRL] && !p.isJumping) {
+    if (actionDown(input, Action::CROUCH) && !p.isJumping) {
         p.state = AnimationState::CROUCHING;
     }
     
     // Attacking
-    if (keys[SDL_SCANCODE_E] && !p.isJumping) {
+    if (actionDown(input, Action::ATTACK) && !p.isJumping) {
         p.state = AnimationState::ATTACKING;
     }
+
+    // Each attack press fires a projectile from the leading edge, if the
+    // player has the stamina for it
+    if (actionPressed(input, Action::ATTACK) && !p.isJumping && p.stamina >= ATTACK_STAMINA) {
+        p.stamina -= ATTACK_STAMINA;
+        float dir = p.facingRight ? 1.0f : -1.0f;
+        float muzzleX = p.facingRight ? p.x + p.width : p.x;
+        float muzzleY = p.y + p.height * 0.5f;
+        spawnProjectile(game.projectiles, muzzleX, muzzleY, dir * PROJECTILE_SPEED, 0, PROJECTILE_LIFETIME, false);
+
+        // Sparks fan out in the attack direction
+        setEmitterAngle(game.particles, game.sparkEmitter, p.facingRight ? 0 : 3.14159f);
+        emitBurst(game.particles, game.sparkEmitter, muzzleX, muzzleY, 24);
+    }
     
     // Return to idle if not moving
     if (!moving && !p.isJumping && p.state != AnimationState::CROUCHING && p.state != AnimationState::ATTACKING) {
@@ -117,8 +191,69 @@ void handleInput(Game& game, const Uint8* keys) {
     }
 }
 
+// Hostile projectiles touching the player. Those in the player's
+// neighbourhood go through the broad-phase as one batch, and those that hit
+// the player's box are checked against the current frame's mask. Each real
+// hit is spent, and the first one past the cooldown costs a heart.
+static void projectileHits(Game& game) {
+    ProjectilePool& pool = game.projectiles;
+    Player& p = game.player;
+    const float half = PROJECTILE_SIZE * 0.5f;
+    AABB reach = playerBounds(p);
+    reach.minX -= BROADPHASE_CELL_SIZE;
+    reach.minY -= BROADPHASE_CELL_SIZE;
+    reach.maxX += BROADPHASE_CELL_SIZE;
+    reach.maxY += BROADPHASE_CELL_SIZE;
+
+    // Scratch for this tick only, so it comes from the frame arena
+    std::pmr::memory_resource* scratch = frameResource();
+    std::pmr::vector<int> nearby(scratch);
+    std::pmr::vector<AABB> boxes(scratch);
+    for (int i = 0; i < pool.count; i++) {
+        if (!pool.hostile[i]) continue;
+        float x = pool.x[i], y = pool.y[i];
+        if (x < reach.minX || x >= reach.maxX || y < reach.minY || y >= reach.maxY) continue;
+        nearby.push_back(i);
+        boxes.push_back({x - half, y - half, x + half, y + half});
+    }
+    int count = static_cast<int>(boxes.size());
+    if (count == 0) return;
+
+    // Grow the id buffer until nothing is cut off
+    std::pmr::vector<int> counts(count, 0, scratch);
+    std::pmr::vector<int> ids(count, 0, scratch);
+    bool truncated = true;
+    while (truncated) {
+        overlapBatch(game.world, boxes.data(), count, LAYER_PLAYER, ids.data(), static_cast<int>(ids.size()),
+                     counts.data(), &truncated);
+        if (truncated) ids.resize(ids.size() * 2);
+    }
+
+    int next = 0;
+    for (int b = 0; b < count; b++) {
+        bool hit = false;
+        for (int k = 0; k < counts[b]; k++) {
+            if (ids[next + k] == game.playerCollider) hit = true;
+        }
+        next += counts[b];
+        if (!hit) continue;
+        const AABB& box = boxes[b];
+        if (!playerPixelOverlap(game, game.projectileMask, static_cast<int>(box.minX), static_cast<int>(box.minY))) {
+            continue;
+        }
+
+        // Spent either way; swept out by the next updateProjectiles
+        pool.life[nearby[b]] = 0;
+        if (game.hitCooldown > 0) continue;
+        game.hitCooldown = PLAYER_HIT_COOLDOWN;
+        // No game over yet: running out of hearts refills them
+        if (--p.health <= 0) p.health = p.maxHealth;
+    }
+}
+
 // Update game state
 void updateGame(Game& game, double deltaTime) {
+    PROFILE_SCOPE("updateGame");
     Player& p = game.player;
     
     // Apply physics
@@ -127,6 +262,10 @@ void updateGame(Game& game, double deltaTime) {
     
     // Ground collision
     if (p.y >= game.groundY) {
+        // Kick up dust on landing
+        if (p.isJumping) {
+            emitBurst(game.particles, game.dustEmitter, p.x + p.width * 0.5f, game.groundY + p.height, 32);
+        }
         p.y = game.groundY;
         p.vely = 0;
         p.isJumping = false;
@@ -136,6 +275,25 @@ void updateGame(Game& game, double deltaTime) {
             p.state = AnimationState::IDLE;
         }
     }
+
+    p.stamina = std::min(PLAYER_MAX_STAMINA, p.stamina + static_cast<float>(STAMINA_REGEN * deltaTime));
+
+    // Refresh moving colliders and rebuild the broad-phase once per tick
+    setCollider(game.world, game.playerCollider, playerBounds(p));
+    buildBroadPhase(game.world);
+
+    // Keep the player inside the camera's dead zone
+    cameraFollow(game.camera, p.x, p.y, p.width, p.height);
+
+    // Projectiles
+    if (game.stressProjectiles > 0) {
+        spawnProjectileStress(game.projectiles, game.stressProjectiles,
+                              game.camera.x + game.camera.viewW * 0.5f, game.camera.y + game.camera.viewH * 0.5f);
+    }
+    updateProjectiles(game.projectiles, game.world, game.jobs, static_cast<float>(deltaTime));
+    game.hitCooldown = std::max(0.0, game.hitCooldown - deltaTime);
+    projectileHits(game);
+    updateParticles(game.particles, static_cast<float>(deltaTime));
     
     // Update animation
     game.animTimer += deltaTime;
@@ -152,63 +310,131 @@ void updateGame(Game& game, double deltaTime) {
     }
 }
 
-// Render the game
-void renderGame(Game& game) {
-    // Clear screen
-    SDL_SetRenderDrawColor(game.renderer, 0, 0, 0, 255);
-    SDL_RenderClear(game.renderer);
-    
-    // Get current animation frame
-    const Animation& anim = game.animations[static_cast<int>(game.player.state)];
-    int frame = game.animFrame;
-
-    int row = anim.startRow;
-    int col = frame;
+// Sheet cell shown for a given frame of an animation
+void animationCell(const Animation& anim, int frame, int& row, int& col) {
+    row = anim.startRow;
+    col = frame;
 
     if (anim.multiRow) {
         row += frame / anim.framesPerRow;
         col = frame % anim.framesPerRow;
     }
+}
 
-    SDL_Rect srcRect = {
-        col * 50,  // Assuming 50px wide frames
-        row * 37,  // Assuming 37px tall frames
-        50,
-        37
-    };
-    
-    // Destination rectangle for player
-    SDL_Rect destRect = {
-        static_cast<int>(game.player.x),
-        static_cast<int>(game.player.y),
-        game.player.width,
-        game.player.height
-    };
+// Collision mask for the player's current frame and facing
+const SpriteMask& playerMask(const Game& game) {
+    const Animation& anim = game.animations[static_cast<int>(game.player.state)];
+    int row, col;
+    animationCell(anim, game.animFrame, row, col);
+    return sheetMask(game.playerMasks, row, col, !game.player.facingRight);
+}
+
+// Narrow-phase hit test against the player: cheap box reject, then masks
+bool playerPixelOverlap(const Game& game, const SpriteMask& mask, int x, int y) {
+    const Player& p = game.player;
+    int px = static_cast<int>(p.x);
+    int py = static_cast<int>(p.y);
+    if (x >= px + p.width || x + mask.width <= px || y >= py + p.height || y + mask.height <= py) {
+        return false;
+    }
+    return masksOverlap(playerMask(game), px, py, mask, x, y);
+}
+
+// Build this frame's draw list
+void buildDrawList(Game& game) {
+    PROFILE_SCOPE("buildDrawList");
+    DrawList& list = game.drawList;
+    const Camera& camera = game.camera;
+    clearDrawList(list, {0, 0, 0, 255});
     
-    // Draw player
-    SDL_RenderCopyEx(
-        game.renderer,
-        game.playerTexture,
-        &srcRect,
-        &destRect,
-        0,
-        NULL,
-        game.player.facingRight ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL
-    );
+    // Get current animation frame
+    const Animation& anim = game.animations[static_cast<int>(game.player.state)];
+    int row, col;
+    animationCell(anim, game.animFrame, row, col);
+
+    const AtlasRegion& region = game.atlas.regions[game.playerFrames[row * game.sheetColumns + col]];
+
+    // Trimmed frames only cover their opaque pixels, so offset the
+    // destination by where they sat in the untrimmed cell (mirrored when
+    // facing left) and scale as the full cell would be
+    const Player& p = game.player;
+    if (region.rect.w > 0 && cameraVisible(camera, p.x, p.y, p.x + p.width, p.y + p.height)) {
+        float scaleX = static_cast<float>(p.width) / region.sourceW;
+        float scaleY = static_cast<float>(p.height) / region.sourceH;
+        int offsetX = p.facingRight ? region.offsetX : region.sourceW - region.offsetX - region.rect.w;
+
+        SDL_FRect destRect = {
+            cameraScreenX(camera, static_cast<int>(p.x)) + offsetX * scaleX,
+            cameraScreenY(camera, static_cast<int>(p.y)) + region.offsetY * scaleY,
+            region.rect.w * scaleX,
+            region.rect.h * scaleY
+        };
+
+        // Draw player
+        drawSprite(list, region.rect, destRect, p.facingRight ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL);
+    }
     
-    // Draw ground line
-    SDL_SetRenderDrawColor(game.renderer, 255, 255, 255, 255);
-    SDL_RenderDrawLine(game.renderer, 0, static_cast<int>(game.groundY), 
-                      SCREEN_WIDTH, static_cast<int>(game.groundY));
+    // Draw projectiles in one batch
+    renderProjectiles(game.projectiles, game.jobs, list, game.atlas, camera);
+
+    // Draw particles in one batch
+    renderParticles(game.particles, list, game.atlas, camera);
     
-    // Present to screen
-    SDL_RenderPresent(game.renderer);
+    // Draw the visible stretch of the ground line
+    if (cameraVisible(camera, 0, game.groundY, WORLD_WIDTH, game.groundY + 1)) {
+        float y = cameraScreenY(camera, game.groundY);
+        drawLine(list, 0, y, camera.viewW, y, {255, 255, 255, 255});
+    }
+
+    // Performance overlay on top of everything else
+    buildOverlay(game.overlay, list, game.text, game.font, game.atlas, SCREEN_WIDTH);
+
+}
+
+// Render the game
+void renderGame(Game& game) {
+    PROFILE_SCOPE("renderGame");
+    buildDrawList(game);
+    if (game.dynamicResolution) {
+        setSceneScale(game.scene, game.resolution.scale);
+    }
+
+    // The HUD layer is only redrawn when a value it shows changed
+    const Player& p = game.player;
+    setHudValues(game.hud, p.health, p.maxHealth, p.stamina / PLAYER_MAX_STAMINA);
+    renderHud(game.hud, game.backend, game.atlas);
+
+    const DrawList& list = game.drawList;
+    backendRender(game.backend, list, game.scene, SCREEN_WIDTH, SCREEN_HEIGHT);
+    compositeHud(game.hud, game.backend, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    FrameStats& stats = game.stats;
+    stats.renderScale = game.dynamicResolution ? game.resolution.scale : 1.0f;
+    stats.sceneW = game.scene.width > 0 ? game.scene.viewW : SCREEN_WIDTH;
+    stats.sceneH = game.scene.width > 0 ? game.scene.viewH : SCREEN_HEIGHT;
+    stats.drawCommands = static_cast<int>(list.commands.size());
+    stats.sprites = 0;
+    for (const DrawCommand& cmd : list.commands) {
+        if (cmd.type == DrawType::SPRITE) stats.sprites++;
+    }
+    stats.quads = list.vertexCount / 4;
+    stats.projectiles = game.projectiles.count;
+    stats.particles = game.particles.alive;
+    stats.damage = game.backend.dirtyRects ? game.backend.damageFraction : 1.0f;
+    stats.hudRedrawn = game.hud.redrawn;
+}
+
+// Present to screen
+void presentGame(Game& game) {
+    PROFILE_SCOPE("present");
+    backendPresent(game.backend);
 }
 
 // Clean up resources
 void cleanup(Game& game) {
-    SDL_DestroyTexture(game.playerTexture);
-    SDL_DestroyRenderer(game.renderer);
+    destroyHud(game.hud);
+    destroyBackend(game.backend);
+    destroyAtlas(game.atlas);
     SDL_DestroyWindow(game.window);
     IMG_Quit();
     SDL_Quit();
@@ -0,0 +1,122 @@
+#include "hud.h"
+#include "log.h"
+#include "SDL2/SDL_image.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Gap between hearts, and between the hearts and the bar, in art texels
+static const int HUD_GAP = 2;
+static const SDL_Color HUD_EMPTY_HEART = {40, 40, 40, 160};
+static const SDL_Color HUD_FILL = {70, 200, 90, 255};
+static const SDL_Color HUD_FILL_BACK = {20, 40, 20, 160};
+
+static int loadImage(Atlas& atlas, const char* path) {
+    SDL_Surface* image = IMG_Load(path);
+    if (!image) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to load {}: {}", path, IMG_GetError());
+        return -1;
+    }
+    SDL_Rect rect = {0, 0, image->w, image->h};
+    int region = atlasAdd(atlas, image, rect);
+    SDL_FreeSurface(image);
+    return region;
+}
+
+bool loadHud(Hud& hud, Atlas& atlas) {
+    hud.heartRegion = loadImage(atlas, "assets/Heart.png");
+    hud.barRegion = loadImage(atlas, "assets/Bar.png");
+    hud.fillRegion = atlasAddSolid(atlas, 4, 0xffffff);
+    if (hud.heartRegion < 0 || hud.barRegion < 0 || hud.fillRegion < 0) return false;
+
+    // The bar's art has a one-texel outline around its interior
+    const SDL_Rect& bar = atlas.regions[hud.barRegion].rect;
+    hud.fillWidth = bar.w - 2;
+    hud.fillHeight = bar.h - 2;
+    initDrawList(hud.list);
+    hud.shown = {-1, -1, -1};
+    hud.dirty = true;
+    return true;
+}
+
+bool initHudLayer(Hud& hud, RenderBackend& backend, const Atlas& atlas) {
+    const SDL_Rect& heart = atlas.regions[hud.heartRegion].rect;
+    const SDL_Rect& bar = atlas.regions[hud.barRegion].rect;
+    int width = std::max(HUD_MAX_HEARTS * (heart.w + HUD_GAP) - HUD_GAP, bar.w);
+    int height = heart.h + HUD_GAP + bar.h;
+    hud.dirty = true;
+    return initLayer(backend, hud.layer, width * HUD_SCALE, height * HUD_SCALE);
+}
+
+void destroyHud(Hud& hud) {
+    destroyLayer(hud.layer);
+}
+
+void setHudValues(Hud& hud, int health, int maxHealth, float stamina) {
+    stamina = std::max(0.0f, std::min(1.0f, stamina));
+    HudValues values = {health, std::min(maxHealth, HUD_MAX_HEARTS),
+                        static_cast<int>(std::lround(stamina * hud.fillWidth))};
+    if (values.health == hud.shown.health && values.maxHealth == hud.shown.maxHealth &&
+        values.staminaFill == hud.shown.staminaFill) return;
+    hud.shown = values;
+    hud.dirty = true;
+    hud.changes++;
+}
+
+// A tinted quad of src at (x, y), w x h art texels, in layer pixels
+static void hudQuad(SDL_Vertex* q, const Atlas& atlas, const SDL_Rect& src, int x, int y, int w, int h,
+                    SDL_Color color) {
+    float invW = 1.0f / atlas.width, invH = 1.0f / atlas.height;
+    float u0 = src.x * invW, v0 = src.y * invH;
+    float u1 = (src.x + src.w) * invW, v1 = (src.y + src.h) * invH;
+    float x0 = static_cast<float>(x * HUD_SCALE), y0 = static_cast<float>(y * HUD_SCALE);
+    float x1 = x0 + w * HUD_SCALE, y1 = y0 + h * HUD_SCALE;
+    q[0] = {{x0, y0}, color, {u0, v0}};
+    q[1] = {{x1, y0}, color, {u1, v0}};
+    q[2] = {{x1, y1}, color, {u1, v1}};
+    q[3] = {{x0, y1}, color, {u0, v1}};
+}
+
+void renderHud(Hud& hud, RenderBackend& backend, const Atlas& atlas) {
+    hud.redrawn = false;
+    if (!hud.dirty || hud.layer.width == 0) return;
+
+    DrawList& list = hud.list;
+    clearDrawList(list, {0, 0, 0, 0});
+    SDL_Vertex* out = beginQuads(list, HUD_MAX_HEARTS + 3);
+    if (!out) return;
+    int quads = 0;
+
+    // Hearts, greyed out past the current health
+    const SDL_Rect& heart = atlas.regions[hud.heartRegion].rect;
+    for (int i = 0; i < hud.shown.maxHealth; i++) {
+        SDL_Color color = i < hud.shown.health ? SDL_Color{255, 255, 255, 255} : HUD_EMPTY_HEART;
+        hudQuad(&out[quads++ * 4], atlas, heart, i * (heart.w + HUD_GAP), 0, heart.w, heart.h, color);
+    }
+
+    // The fill sits inside the bar's outline; sample the solid's centre so
+    // filtering never reaches its edge
+    const SDL_Rect& solid = atlas.regions[hud.fillRegion].rect;
+    SDL_Rect centre = {solid.x + 1, solid.y + 1, solid.w - 2, solid.h - 2};
+    int barY = heart.h + HUD_GAP;
+    hudQuad(&out[quads++ * 4], atlas, centre, 1, barY + 1, hud.fillWidth, hud.fillHeight, HUD_FILL_BACK);
+    if (hud.shown.staminaFill > 0) {
+        hudQuad(&out[quads++ * 4], atlas, centre, 1, barY + 1, hud.shown.staminaFill, hud.fillHeight, HUD_FILL);
+    }
+    const SDL_Rect& bar = atlas.regions[hud.barRegion].rect;
+    hudQuad(&out[quads++ * 4], atlas, bar, 0, barY, bar.w, bar.h, {255, 255, 255, 255});
+    endQuads(list, quads);
+
+    backendRenderLayer(backend, hud.layer, list);
+    hud.dirty = false;
+    hud.redrawn = true;
+    hud.redraws++;
+}
+
+void compositeHud(Hud& hud, RenderBackend& backend, int logicalW, int logicalH) {
+    if (hud.layer.width == 0) return;
+    SDL_FRect dst = {static_cast<float>(HUD_MARGIN), static_cast<float>(HUD_MARGIN),
+                     static_cast<float>(hud.layer.width), static_cast<float>(hud.layer.height)};
+    backendCompositeLayer(backend, hud.layer, dst, logicalW, logicalH);
+    hud.frames++;
+}
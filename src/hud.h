@@ -0,0 +1,53 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "render.h"
+#include "backend.h"
+
+// Hearts shown at most; one per point of health
+const int HUD_MAX_HEARTS = 10;
+// The 13x12 heart and 52x9 bar art is drawn at this many pixels per texel
+const int HUD_SCALE = 2;
+// Distance from the top-left of the screen, logical pixels
+const int HUD_MARGIN = 8;
+
+//structure
+// What the HUD shows. The layer is only redrawn when these change.
+struct HudValues {
+    int health, maxHealth;
+    int staminaFill;          // Filled pixels of the bar's interior
+};
+
+// Retained-mode HUD: hearts and the stamina bar are composed into a cached
+// layer, which costs one blit per frame until a bound value changes
+struct Hud {
+    int heartRegion;          // Heart.png
+    int barRegion;            // Bar.png, an outline with a clear interior
+    int fillRegion;           // Solid white, tinted for the bar's fill
+    int fillWidth;            // Bar interior size in art texels
+    int fillHeight;
+    DrawList list;            // Rebuilt only when the layer is redrawn
+    RenderLayer layer;
+    HudValues shown;          // What the layer holds
+    bool dirty;
+
+    // Dirty counters since init
+    Uint64 frames;            // Frames the HUD was composited
+    Uint64 changes;           // setHudValues calls that changed something
+    Uint64 redraws;           // Times the layer was redrawn
+    bool redrawn;             // The last renderHud redrew the layer
+};
+
+//function definaction
+// Load the art into the atlas; call before finalizeAtlas
+bool loadHud(Hud& hud, Atlas& atlas);
+// Create the layer on the backend; the HUD draws nothing until this succeeds
+bool initHudLayer(Hud& hud, RenderBackend& backend, const Atlas& atlas);
+void destroyHud(Hud& hud);
+// Bind this frame's values; marks the HUD dirty only if something changed.
+// stamina is 0..1 and is quantised to whole bar pixels first.
+void setHudValues(Hud& hud, int health, int maxHealth, float stamina);
+// Redraw the layer if dirty; call before backendRender
+void renderHud(Hud& hud, RenderBackend& backend, const Atlas& atlas);
+// Draw the cached layer over the frame; call after backendRender
+void compositeHud(Hud& hud, RenderBackend& backend, int logicalW, int logicalH);
@@ -0,0 +1,108 @@
+#include "input.h"
+
+void initInput(InputSystem& input) {
+    input.head = 0;
+    input.tail = 0;
+    input.dropped = 0;
+    input.overflowed = false;
+    input.held = 0;
+    input.quit = false;
+    input.exposed = false;
+    input.targetsReset = false;
+    input.overlayToggled = false;
+    input.captureRequested = false;
+    input.consumedCount = 0;
+    input.bindings[static_cast<int>(Action::LEFT)] = SDL_SCANCODE_A;
+    input.bindings[static_cast<int>(Action::RIGHT)] = SDL_SCANCODE_D;
+    input.bindings[static_cast<int>(Action::JUMP)] = SDL_SCANCODE_SPACE;
+    input.bindings[static_cast<int>(Action::CROUCH)] = SDL_SCANCODE_LCTRL;
+    input.bindings[static_cast<int>(Action::ATTACK)] = SDL_SCANCODE_E;
+}
+
+static void pushEvent(InputSystem& input, const InputEvent& ev) {
+    if (input.head - input.tail == INPUT_QUEUE_SIZE) {
+        // Full: drop the newest, so the queued edges stay in order. A lost
+        // release would leave its action held, so consumeInput resyncs.
+        input.dropped++;
+        input.overflowed = true;
+        return;
+    }
+    input.events[input.head & (INPUT_QUEUE_SIZE - 1)] = ev;
+    input.head++;
+}
+
+void pollInput(InputSystem& input) {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            input.quit = true;
+        }
+        else if (event.type == SDL_WINDOWEVENT) {
+            Uint8 what = event.window.event;
+            if (what == SDL_WINDOWEVENT_EXPOSED || what == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                what == SDL_WINDOWEVENT_RESTORED) {
+                input.exposed = true;
+            }
+        }
+        else if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+            input.targetsReset = true;
+        }
+        else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+            if (event.key.repeat) continue;
+            if (event.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
+                input.quit = true;
+                continue;
+            }
+            if (event.key.keysym.scancode == SDL_SCANCODE_F3) {
+                if (event.type == SDL_KEYDOWN) input.overlayToggled = true;
+                continue;
+            }
+            if (event.key.keysym.scancode == SDL_SCANCODE_F4) {
+                if (event.type == SDL_KEYDOWN) input.captureRequested = true;
+                continue;
+            }
+            pushEvent(input, {event.key.timestamp, event.key.keysym.scancode, event.type == SDL_KEYDOWN});
+        }
+    }
+}
+
+ActionState consumeInput(InputSystem& input) {
+    ActionState state = {0, 0, 0};
+    input.consumedCount = 0;
+    while (input.tail != input.head) {
+        const InputEvent& ev = input.events[input.tail & (INPUT_QUEUE_SIZE - 1)];
+        input.tail++;
+        bool bound = false;
+        for (int a = 0; a < static_cast<int>(Action::COUNT); a++) {
+            if (input.bindings[a] != ev.scancode) continue;
+            Uint32 bit = 1u << a;
+            bound = true;
+            if (ev.down) {
+                state.pressed |= bit;
+                input.held |= bit;
+            } else {
+                state.released |= bit;
+                input.held &= ~bit;
+            }
+        }
+        if (bound && ev.down) {
+            input.consumedTimes[input.consumedCount++] = ev.timestamp;
+        }
+    }
+
+    if (input.overflowed) {
+        const Uint8* keys = SDL_GetKeyboardState(NULL);
+        for (int a = 0; a < static_cast<int>(Action::COUNT); a++) {
+            Uint32 bit = 1u << a;
+            if (keys[input.bindings[a]]) {
+                input.held |= bit;
+            } else {
+                input.held &= ~bit;
+            }
+        }
+        input.overflowed = false;
+    }
+
+    state.held = input.held;
+    return state;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "SDL2/SDL.h"
+
+// Event ring capacity; must be a power of two
+const unsigned INPUT_QUEUE_SIZE = 256;
+
+//enum
+enum class Action {
+    LEFT,
+    RIGHT,
+    JUMP,
+    CROUCH,
+    ATTACK,
+    COUNT
+};
+
+//structure
+struct InputEvent {
+    Uint32 timestamp;     // SDL event timestamp (ms)
+    SDL_Scancode scancode;
+    bool down;
+};
+
+// What the simulation sees for one tick: one bit per Action
+struct ActionState {
+    Uint32 held;          // Down at the end of the tick window
+    Uint32 pressed;       // Went down during the window
+    Uint32 released;      // Went up during the window
+};
+
+// Key events are queued with their timestamps as they are pumped, so taps
+// shorter than a frame still reach the simulation as a press edge
+struct InputSystem {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    unsigned head, tail;
+    unsigned dropped;
+    bool overflowed;      // Events were dropped; held is resynced from the keyboard
+    SDL_Scancode bindings[static_cast<int>(Action::COUNT)];
+    Uint32 held;
+    bool quit;
+    bool exposed;         // Window contents were lost; the consumer clears it
+    bool targetsReset;    // Render target textures were wiped (device reset); the consumer clears it
+    bool overlayToggled;  // F3 went down; the consumer clears it
+    bool captureRequested; // F4 went down: capture a trace; the consumer clears it
+
+    // Timestamps of the presses drained by the last consumeInput
+    Uint32 consumedTimes[INPUT_QUEUE_SIZE];
+    unsigned consumedCount;
+};
+
+//function definaction
+void initInput(InputSystem& input);
+// Pump SDL and move key events into the ring; call right before the sim step
+void pollInput(InputSystem& input);
+// Drain the ring into this tick's action edges and held state
+ActionState consumeInput(InputSystem& input);
+
+inline Uint32 actionBit(Action a) {
+    return 1u << static_cast<int>(a);
+}
+
+// Held, or tapped and already released within this tick
+inline bool actionDown(const ActionState& s, Action a) {
+    return ((s.held | s.pressed) & actionBit(a)) != 0;
+}
+
+inline bool actionPressed(const ActionState& s, Action a) {
+    return (s.pressed & actionBit(a)) != 0;
+}
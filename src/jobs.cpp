@@ -0,0 +1,260 @@
+#include "jobs.h"
+#include "log.h"
+#include "memory.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// Index of the worker running on this thread; threads the system did not
+// start share worker 0's deque (every deque is locked, so that is safe)
+static thread_local int currentWorker = 0;
+// False on those outside threads: they count their jobs in the system's
+// shared atomics, since worker 0's plain counters belong to its own thread
+static thread_local bool ownsWorker = false;
+
+void initJobCounter(JobCounter& counter) {
+    counter.pending = 0;
+    counter.lock = 0;
+    counter.continuationCount = 0;
+}
+
+static bool popJob(JobWorker& worker, Job& job) {
+    SDL_AtomicLock(&worker.lock);
+    bool found = worker.bottom != worker.top;
+    if (found) {
+        job = worker.jobs[--worker.bottom & (JOB_QUEUE_SIZE - 1)];
+    }
+    SDL_AtomicUnlock(&worker.lock);
+    return found;
+}
+
+static bool stealJob(JobWorker& victim, Job& job) {
+    SDL_AtomicLock(&victim.lock);
+    bool found = victim.bottom != victim.top;
+    if (found) {
+        job = victim.jobs[victim.top++ & (JOB_QUEUE_SIZE - 1)];
+    }
+    SDL_AtomicUnlock(&victim.lock);
+    return found;
+}
+
+static bool findJob(JobSystem& system, int self, Job& job) {
+    if (popJob(system.workers[self], job)) return true;
+    int n = static_cast<int>(system.workers.size());
+    for (int i = 1; i < n; i++) {
+        if (stealJob(system.workers[(self + i) % n], job)) {
+            if (ownsWorker) {
+                system.workers[self].stolen++;
+            } else {
+                system.outsideStolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void runJob(JobSystem& system, const Job& job);
+
+static void pushJob(JobSystem& system, const Job& job) {
+    JobWorker& worker = system.workers[currentWorker];
+    SDL_AtomicLock(&worker.lock);
+    bool full = worker.bottom - worker.top == JOB_QUEUE_SIZE;
+    if (!full) {
+        worker.jobs[worker.bottom++ & (JOB_QUEUE_SIZE - 1)] = job;
+    }
+    SDL_AtomicUnlock(&worker.lock);
+
+    if (full) {
+        // No room to defer it, so do it now
+        runJob(system, job);
+        return;
+    }
+    if (system.sleepers > 0) {
+        SDL_SemPost(system.wake);
+    }
+}
+
+static void runJob(JobSystem& system, const Job& job) {
+    {
+        PROFILE_SCOPE("job");
+        job.function(job.data, job.begin, job.end);
+    }
+    if (ownsWorker) {
+        system.workers[currentWorker].executed++;
+    } else {
+        system.outsideExecuted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    JobCounter* counter = job.counter;
+    if (!counter) return;
+
+    // Decrement under the counter's lock so a dependency being parked
+    // concurrently either sees a non-zero count or gets released here
+    Job ready[JOB_MAX_CONTINUATIONS];
+    int readyCount = 0;
+    SDL_AtomicLock(&counter->lock);
+    if (--counter->pending == 0) {
+        readyCount = counter->continuationCount;
+        std::copy(counter->continuations, counter->continuations + readyCount, ready);
+        counter->continuationCount = 0;
+    }
+    SDL_AtomicUnlock(&counter->lock);
+
+    for (int i = 0; i < readyCount; i++) {
+        pushJob(system, ready[i]);
+    }
+}
+
+static int workerMain(void* arg) {
+    JobWorker* worker = static_cast<JobWorker*>(arg);
+    JobSystem& system = *worker->system;
+    currentWorker = worker->index;
+    ownsWorker = true;
+    char name[32];
+    snprintf(name, sizeof(name), "worker %d", worker->index);
+    profilerThreadName(name);
+    allocationThreadName(name);
+
+    while (!system.quit) {
+        Job job;
+        if (findJob(system, worker->index, job)) {
+            runJob(system, job);
+            continue;
+        }
+        // Announce we are about to sleep, then look once more: a job pushed
+        // in between either sees the sleeper or is found here
+        system.sleepers++;
+        if (findJob(system, worker->index, job)) {
+            system.sleepers--;
+            runJob(system, job);
+            continue;
+        }
+        SDL_SemWait(system.wake);
+        system.sleepers--;
+    }
+    return 0;
+}
+
+bool initJobSystem(JobSystem& system, int threads, bool deterministic) {
+    if (threads <= 0) threads = SDL_GetCPUCount();
+    threads = std::max(1, threads);
+
+    system.deterministic = deterministic;
+    system.sleepers = 0;
+    system.quit = false;
+    system.wake = SDL_CreateSemaphore(0);
+    if (!system.wake) {
+        LOG_ERROR(LogCategory::JOBS, "SDL_CreateSemaphore failed: {}", SDL_GetError());
+        return false;
+    }
+
+    system.workers.resize(threads);
+    for (int i = 0; i < threads; i++) {
+        JobWorker& w = system.workers[i];
+        w.lock = 0;
+        w.top = 0;
+        w.bottom = 0;
+        w.thread = NULL;
+        w.system = &system;
+        w.index = i;
+        w.active = i == 0;
+        w.executed = 0;
+        w.stolen = 0;
+    }
+    currentWorker = 0;
+    ownsWorker = true;
+    system.outsideExecuted.store(0, std::memory_order_relaxed);
+    system.outsideStolen.store(0, std::memory_order_relaxed);
+    system.activeWorkers = 1;
+
+    // Running workers steal from every queue, so the vector must not change
+    // from here on; a worker that fails to start is left inactive instead
+    for (int i = 1; i < threads; i++) {
+        JobWorker& w = system.workers[i];
+        w.thread = SDL_CreateThread(workerMain, "job worker", &w);
+        if (!w.thread) {
+            LOG_ERROR(LogCategory::JOBS, "SDL_CreateThread failed for worker {}: {}", i, SDL_GetError());
+            continue;
+        }
+        w.active = true;
+        system.activeWorkers++;
+    }
+    return true;
+}
+
+void shutdownJobSystem(JobSystem& system) {
+    if (!system.wake) return;
+    system.quit = true;
+    for (int i = 1; i < system.activeWorkers; i++) {
+        SDL_SemPost(system.wake);
+    }
+    for (size_t i = 1; i < system.workers.size(); i++) {
+        if (system.workers[i].active) SDL_WaitThread(system.workers[i].thread, NULL);
+    }
+    system.workers.clear();
+    system.activeWorkers = 0;
+    SDL_DestroySemaphore(system.wake);
+    system.wake = NULL;
+}
+
+void jobSubmit(JobSystem& system, JobFunction function, void* data, int begin, int end,
+               JobCounter* counter, JobCounter* dependency) {
+    if (counter) counter->pending++;
+    Job job = {function, data, begin, end, counter};
+
+    if (dependency) {
+        SDL_AtomicLock(&dependency->lock);
+        if (dependency->pending > 0 && dependency->continuationCount < JOB_MAX_CONTINUATIONS) {
+            dependency->continuations[dependency->continuationCount++] = job;
+            SDL_AtomicUnlock(&dependency->lock);
+            return;
+        }
+        SDL_AtomicUnlock(&dependency->lock);
+        // Already done, or no room to park: satisfy it before queueing
+        jobWait(system, *dependency);
+    }
+    pushJob(system, job);
+}
+
+void jobWait(JobSystem& system, JobCounter& counter) {
+    while (counter.pending > 0) {
+        Job job;
+        if (findJob(system, currentWorker, job)) {
+            runJob(system, job);
+        } else {
+            SDL_CPUPauseInstruction();
+        }
+    }
+    // The last finisher may still hold the lock; let it go before the
+    // caller is free to destroy the counter
+    SDL_AtomicLock(&counter.lock);
+    SDL_AtomicUnlock(&counter.lock);
+}
+
+int jobGrain(const JobSystem& system, int count, int grain) {
+    if (grain > 0) return grain;
+    int chunks = system.deterministic ? JOB_DETERMINISTIC_CHUNKS
+                                      : system.activeWorkers * 4;
+    return std::max(1, (count + chunks - 1) / chunks);
+}
+
+void parallelFor(JobSystem& system, int count, int grain, JobFunction function, void* data) {
+    if (count <= 0) return;
+    grain = jobGrain(system, count, grain);
+    if (grain >= count || system.activeWorkers <= 1) {
+        // Same chunk boundaries as the parallel path, run in order here
+        for (int b = 0; b < count; b += grain) {
+            function(data, b, std::min(b + grain, count));
+        }
+        return;
+    }
+
+    JobCounter counter;
+    initJobCounter(counter);
+    for (int b = 0; b < count; b += grain) {
+        jobSubmit(system, function, data, b, std::min(b + grain, count), &counter, NULL);
+    }
+    jobWait(system, counter);
+}
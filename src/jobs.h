@@ -0,0 +1,81 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <atomic>
+#include <vector>
+
+// Per-worker deque capacity; must be a power of two
+const unsigned JOB_QUEUE_SIZE = 1024;
+// Jobs that can wait on one counter before it must be waited on inline
+const int JOB_MAX_CONTINUATIONS = 16;
+// Chunks per parallelFor when the grain is picked automatically in
+// deterministic mode, where it must not depend on the thread count
+const int JOB_DETERMINISTIC_CHUNKS = 64;
+
+// A job processes the index range [begin, end)
+typedef void (*JobFunction)(void* data, int begin, int end);
+
+struct JobCounter;
+
+//structure
+struct Job {
+    JobFunction function;
+    void* data;
+    int begin, end;
+    JobCounter* counter;      // Decremented when the job finishes
+};
+
+// Tracks outstanding jobs. Jobs submitted with this counter as their
+// dependency are parked here and released when it reaches zero.
+struct JobCounter {
+    std::atomic<int> pending;
+    SDL_SpinLock lock;
+    Job continuations[JOB_MAX_CONTINUATIONS];
+    int continuationCount;
+};
+
+struct JobSystem;
+
+// Owner pushes and pops at the bottom (LIFO, cache-warm); thieves take the
+// oldest job from the top
+struct JobWorker {
+    SDL_SpinLock lock;
+    Job jobs[JOB_QUEUE_SIZE];
+    unsigned top, bottom;
+    SDL_Thread* thread;
+    JobSystem* system;
+    int index;
+    bool active;              // False if its thread could not be started
+    unsigned executed, stolen;
+};
+
+// Worker 0 is the thread that called initJobSystem; it runs jobs while it
+// waits. The others are SDL threads that sleep when there is nothing to steal.
+// workers keeps its size while threads run; a worker whose thread failed to
+// start stays in it, inactive, with an empty queue.
+struct JobSystem {
+    std::vector<JobWorker> workers;
+    int activeWorkers;        // Including worker 0
+    SDL_sem* wake;
+    std::atomic<int> sleepers;
+    std::atomic<bool> quit;
+    bool deterministic;
+    // Jobs run and stolen by threads outside the pool
+    std::atomic<unsigned> outsideExecuted, outsideStolen;
+};
+
+//function definaction
+// threads <= 0 picks one per CPU
+bool initJobSystem(JobSystem& system, int threads, bool deterministic);
+void shutdownJobSystem(JobSystem& system);
+void initJobCounter(JobCounter& counter);
+// Queue a job. counter (optional) is incremented now and decremented when the
+// job finishes; dependency (optional) must reach zero before the job may run.
+void jobSubmit(JobSystem& system, JobFunction function, void* data, int begin, int end,
+               JobCounter* counter, JobCounter* dependency);
+// Run other jobs until the counter reaches zero
+void jobWait(JobSystem& system, JobCounter& counter);
+// Split [0, count) into chunks of grain and wait for all of them. grain <= 0
+// picks one. Chunk boundaries depend only on count and grain, so per-chunk
+// results combined in chunk order are reproducible across thread counts.
+void parallelFor(JobSystem& system, int count, int grain, JobFunction function, void* data);
+int jobGrain(const JobSystem& system, int count, int grain);
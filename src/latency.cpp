@@ -0,0 +1,100 @@
+#include "latency.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+void initLatencyTracker(LatencyTracker& tracker, int injectInterval) {
+    tracker.pendingCount = 0;
+    std::fill(tracker.histogram, tracker.histogram + LATENCY_BUCKETS, 0u);
+    tracker.samples = 0;
+    tracker.dropped = 0;
+    tracker.minMs = 0xffffffffu;
+    tracker.maxMs = 0;
+    tracker.sumMs = 0;
+    tracker.injectKey = SDL_SCANCODE_E;
+    tracker.injectInterval = injectInterval;
+}
+
+void latencyInject(LatencyTracker& tracker, unsigned frame) {
+    if (tracker.injectInterval <= 0 || frame % tracker.injectInterval != 0) return;
+
+    // A full tap (down then up) lands in one tick, which also exercises
+    // sub-frame press handling. SDL_PushEvent stamps both with the current time.
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_KEYDOWN;
+    event.key.state = SDL_PRESSED;
+    event.key.keysym.scancode = tracker.injectKey;
+    event.key.keysym.sym = SDL_GetKeyFromScancode(tracker.injectKey);
+    SDL_PushEvent(&event);
+
+    event.type = SDL_KEYUP;
+    event.key.state = SDL_RELEASED;
+    SDL_PushEvent(&event);
+}
+
+void latencyOnTick(LatencyTracker& tracker, const InputSystem& input, Uint32 tick) {
+    for (unsigned i = 0; i < input.consumedCount; i++) {
+        if (tracker.pendingCount == LATENCY_MAX_PENDING) {
+            tracker.dropped++;
+            continue;
+        }
+        tracker.pending[tracker.pendingCount++] = {input.consumedTimes[i], tick};
+    }
+}
+
+void latencyOnPresent(LatencyTracker& tracker, Uint32 tickShown, Uint32 presentTime) {
+    int kept = 0;
+    for (int i = 0; i < tracker.pendingCount; i++) {
+        const LatencySample& s = tracker.pending[i];
+        if (s.tick > tickShown) {
+            tracker.pending[kept++] = s;
+            continue;
+        }
+        Uint32 ms = presentTime - s.eventTime;
+        tracker.histogram[std::min<Uint32>(ms, LATENCY_BUCKETS - 1)]++;
+        tracker.samples++;
+        tracker.sumMs += ms;
+        tracker.minMs = std::min(tracker.minMs, ms);
+        tracker.maxMs = std::max(tracker.maxMs, ms);
+    }
+    tracker.pendingCount = kept;
+}
+
+// Smallest bucket holding the given fraction of samples
+static int percentile(const LatencyTracker& tracker, double fraction) {
+    unsigned target = static_cast<unsigned>(fraction * tracker.samples);
+    unsigned seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += tracker.histogram[b];
+        if (seen > target) return b;
+    }
+    return LATENCY_BUCKETS - 1;
+}
+
+void printLatencyReport(const LatencyTracker& tracker) {
+    std::cout << "Input-to-present latency (ms, SDL tick resolution)\n";
+    if (tracker.samples == 0) {
+        std::cout << "  no samples\n";
+        return;
+    }
+    std::cout << "  samples " << tracker.samples
+              << "  min " << tracker.minMs
+              << "  mean " << tracker.sumMs / tracker.samples
+              << "  p50 " << percentile(tracker, 0.50)
+              << "  p90 " << percentile(tracker, 0.90)
+              << "  p99 " << percentile(tracker, 0.99)
+              << "  max " << tracker.maxMs;
+    if (tracker.dropped) std::cout << "  dropped " << tracker.dropped;
+    std::cout << "\n";
+
+    unsigned peak = *std::max_element(tracker.histogram, tracker.histogram + LATENCY_BUCKETS);
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        if (!tracker.histogram[b]) continue;
+        int bar = static_cast<int>(40.0 * tracker.histogram[b] / peak) + 1;
+        std::cout << "  " << (b == LATENCY_BUCKETS - 1 ? ">=" : "  ") << b << "\t"
+                  << tracker.histogram[b] << "\t" << std::string(bar, '#') << "\n";
+    }
+    std::cout << std::flush;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "input.h"
+
+const int LATENCY_MAX_PENDING = 1024;
+const int LATENCY_BUCKETS = 256;   // 1 ms each; the last one collects overflow
+
+//structure
+struct LatencySample {
+    Uint32 eventTime;     // SDL timestamp of the key event
+    Uint32 tick;          // Sim tick that consumed it
+};
+
+// Follows key presses from their SDL timestamp, through the tick that
+// consumed them, to the first present that showed that tick
+struct LatencyTracker {
+    LatencySample pending[LATENCY_MAX_PENDING];
+    int pendingCount;
+    unsigned histogram[LATENCY_BUCKETS];
+    unsigned samples;
+    unsigned dropped;
+    Uint32 minMs, maxMs;
+    double sumMs;
+
+    // Synthetic input
+    SDL_Scancode injectKey;
+    int injectInterval;   // Frames between taps, 0 = off
+};
+
+//function definaction
+void initLatencyTracker(LatencyTracker& tracker, int injectInterval);
+// Push a synthetic key tap through the SDL event queue every injectInterval
+// frames. Call right after present: the sample then covers a whole frame of
+// queueing before the next pollInput, the worst case for a real press.
+void latencyInject(LatencyTracker& tracker, unsigned frame);
+// Record the presses consumed by a sim tick
+void latencyOnTick(LatencyTracker& tracker, const InputSystem& input, Uint32 tick);
+// Resolve everything consumed up to and including tickShown
+void latencyOnPresent(LatencyTracker& tracker, Uint32 tickShown, Uint32 presentTime);
+void printLatencyReport(const LatencyTracker& tracker);
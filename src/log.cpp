@@ -0,0 +1,245 @@
+#include "log.h"
+#include "memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+// Formatted text the writer collects before each fwrite
+static const int LOG_BATCH_BYTES = 1 << 16;
+static const int LOG_LINE_BYTES = 512;
+
+// Single producer (the owning thread), single consumer (the writer). head
+// is published with release after the record is filled; tail with release
+// after the writer is done with it. writing is set by the producer from
+// logBegin to logCommit, so shutdownLog can wait for records in flight.
+struct LogRing {
+    LogRecord records[LOG_RING_RECORDS];
+    std::atomic<Uint32> head;
+    std::atomic<Uint32> tail;
+    std::atomic<Uint64> dropped;
+    std::atomic<bool> writing;
+};
+
+// Made once by the first initLog and kept for the life of the process, since
+// threads hold on to the ring they claimed
+static LogRing* rings = NULL;
+static std::atomic<int> ringCount(0);
+static thread_local LogRing* threadRing = NULL;
+static thread_local bool threadRingFailed = false;
+// Used on the calling thread while there is no writer
+static thread_local LogRecord directRecord;
+
+static std::atomic<bool> running(false);
+static std::atomic<bool> quit(false);
+static SDL_Thread* writer = NULL;
+static SDL_sem* wake = NULL;
+static Uint64 startTime = 0;
+static char batch[LOG_BATCH_BYTES];
+static int batchUsed = 0;
+
+static const char* levelName(int level) {
+    switch (level) {
+    case LOG_LEVEL_DEBUG: return "debug";
+    case LOG_LEVEL_INFO: return "info";
+    case LOG_LEVEL_WARN: return "warning";
+    case LOG_LEVEL_ERROR: return "error";
+    default: return "?";
+    }
+}
+
+static const char* categoryName(LogCategory category) {
+    switch (category) {
+    case LogCategory::CORE: return "core";
+    case LogCategory::ASSETS: return "assets";
+    case LogCategory::RENDER: return "render";
+    case LogCategory::JOBS: return "jobs";
+    case LogCategory::PERF: return "perf";
+    default: return "?";
+    }
+}
+
+// Fill the record's {} placeholders; returns the line's length
+static int formatRecord(const LogRecord& r, char* out, int size) {
+    double seconds = startTime ? static_cast<double>(r.time - startTime) / SDL_GetPerformanceFrequency() : 0.0;
+    int n = snprintf(out, size, "[%8.3f] %s %s: ", seconds, levelName(r.level), categoryName(r.category));
+    int arg = 0;
+    for (const char* f = r.format; *f && n < size - 2; f++) {
+        if (f[0] != '{' || f[1] != '}' || arg >= r.argCount) {
+            out[n++] = *f;
+            continue;
+        }
+        f++;
+        Uint64 v = r.args[arg];
+        int room = size - 1 - n;
+        int written = 0;
+        switch (r.types[arg++]) {
+        case LogArgType::INT: written = snprintf(out + n, room, "%lld", static_cast<long long>(v)); break;
+        case LogArgType::UINT: written = snprintf(out + n, room, "%llu", static_cast<unsigned long long>(v)); break;
+        case LogArgType::DOUBLE: {
+            double d;
+            memcpy(&d, &v, sizeof(d));
+            written = snprintf(out + n, room, "%g", d);
+            break;
+        }
+        case LogArgType::STRING: written = snprintf(out + n, room, "%s", r.text + v); break;
+        case LogArgType::POINTER: written = snprintf(out + n, room, "%p", reinterpret_cast<void*>(v)); break;
+        }
+        n += std::max(0, std::min(written, room - 1));
+    }
+    n = std::min(n, size - 2);
+    out[n++] = '\n';
+    out[n] = 0;
+    return n;
+}
+
+static void flushBatch() {
+    if (batchUsed == 0) return;
+    fwrite(batch, 1, batchUsed, stderr);
+    fflush(stderr);
+    batchUsed = 0;
+}
+
+// Format every published record into the batch. Lines from one thread stay
+// in order; lines from different threads are grouped by thread.
+static void drainRings() {
+    int count = std::min(ringCount.load(std::memory_order_acquire), LOG_MAX_THREADS);
+    for (int i = 0; i < count; i++) {
+        LogRing* ring = &rings[i];
+        Uint32 tail = ring->tail.load(std::memory_order_relaxed);
+        Uint32 head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            if (batchUsed > LOG_BATCH_BYTES - LOG_LINE_BYTES) flushBatch();
+            batchUsed += formatRecord(ring->records[tail % LOG_RING_RECORDS], batch + batchUsed, LOG_LINE_BYTES);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    flushBatch();
+}
+
+static int writerMain(void*) {
+    allocationThreadName("log writer");
+    while (!quit.load(std::memory_order_acquire)) {
+        SDL_SemWaitTimeout(wake, LOG_FLUSH_MS);
+        drainRings();
+    }
+    drainRings();
+    return 0;
+}
+
+bool initLog() {
+    if (running.load(std::memory_order_relaxed)) return true;
+    startTime = SDL_GetPerformanceCounter();
+    if (!rings) {
+        rings = new LogRing[LOG_MAX_THREADS];
+        for (int i = 0; i < LOG_MAX_THREADS; i++) {
+            rings[i].head.store(0, std::memory_order_relaxed);
+            rings[i].tail.store(0, std::memory_order_relaxed);
+            rings[i].dropped.store(0, std::memory_order_relaxed);
+            rings[i].writing.store(false, std::memory_order_relaxed);
+        }
+    }
+    wake = SDL_CreateSemaphore(0);
+    if (!wake) {
+        LOG_ERROR(LogCategory::CORE, "SDL_CreateSemaphore failed for the log: {}", SDL_GetError());
+        return false;
+    }
+    quit.store(false, std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+    writer = SDL_CreateThread(writerMain, "log writer", NULL);
+    if (!writer) {
+        running.store(false, std::memory_order_release);
+        LOG_ERROR(LogCategory::CORE, "SDL_CreateThread failed for the log: {}", SDL_GetError());
+        SDL_DestroySemaphore(wake);
+        wake = NULL;
+        return false;
+    }
+    return true;
+}
+
+void shutdownLog() {
+    if (!running.load(std::memory_order_relaxed)) return;
+    // Later messages are written directly. A thread that saw running before
+    // this is still filling its record; wait for it to commit so the
+    // writer's last drain picks the record up.
+    running.store(false);
+    int count = std::min(ringCount.load(), LOG_MAX_THREADS);
+    for (int i = 0; i < count; i++) {
+        while (rings[i].writing.load()) SDL_CPUPauseInstruction();
+    }
+    quit.store(true, std::memory_order_release);
+    SDL_SemPost(wake);
+    SDL_WaitThread(writer, NULL);
+    writer = NULL;
+    SDL_DestroySemaphore(wake);
+    wake = NULL;
+    Uint64 dropped = logDropped();
+    if (dropped) fprintf(stderr, "%llu log messages dropped\n", static_cast<unsigned long long>(dropped));
+}
+
+Uint64 logDropped() {
+    Uint64 dropped = 0;
+    int count = std::min(ringCount.load(std::memory_order_acquire), LOG_MAX_THREADS);
+    for (int i = 0; i < count; i++) {
+        dropped += rings[i].dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+
+static void fill(LogRecord& r, int level, LogCategory category, const char* format) {
+    r.format = format;
+    r.time = SDL_GetPerformanceCounter();
+    r.level = static_cast<Uint8>(level);
+    r.category = category;
+    r.argCount = 0;
+    r.textUsed = 0;
+}
+
+LogRecord* logBegin(int level, LogCategory category, const char* format) {
+    if (!running.load(std::memory_order_acquire)) {
+        fill(directRecord, level, category, format);
+        return &directRecord;
+    }
+    LogRing* ring = threadRing;
+    if (!ring && !threadRingFailed) {
+        // Threads past LOG_MAX_THREADS write directly
+        int index = ringCount.fetch_add(1);
+        if (index < LOG_MAX_THREADS) ring = threadRing = &rings[index];
+        threadRingFailed = !ring;
+    }
+    if (!ring) {
+        fill(directRecord, level, category, format);
+        return &directRecord;
+    }
+    // Check running again now that shutdownLog can see this thread writing
+    ring->writing.store(true);
+    if (!running.load()) {
+        ring->writing.store(false, std::memory_order_release);
+        fill(directRecord, level, category, format);
+        return &directRecord;
+    }
+    Uint32 head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= static_cast<Uint32>(LOG_RING_RECORDS)) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        ring->writing.store(false, std::memory_order_release);
+        return NULL;
+    }
+    LogRecord& r = ring->records[head % LOG_RING_RECORDS];
+    fill(r, level, category, format);
+    return &r;
+}
+
+void logCommit(LogRecord* record) {
+    if (record == &directRecord) {
+        char line[LOG_LINE_BYTES];
+        int n = formatRecord(*record, line, sizeof(line));
+        fwrite(line, 1, n, stderr);
+        fflush(stderr);
+        return;
+    }
+    LogRing* ring = threadRing;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    ring->writing.store(false, std::memory_order_release);
+}
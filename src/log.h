@@ -0,0 +1,138 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <cstddef>
+#include <cstring>
+
+// Levels; messages below LOG_MIN_LEVEL are compiled out
+const int LOG_LEVEL_DEBUG = 0;
+const int LOG_LEVEL_INFO = 1;
+const int LOG_LEVEL_WARN = 2;
+const int LOG_LEVEL_ERROR = 3;
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+// Bit per LogCategory; categories outside the mask are compiled out
+#ifndef LOG_CATEGORIES
+#define LOG_CATEGORIES 0xffffffffu
+#endif
+
+// Threads with their own ring, and records each ring holds; a thread whose
+// ring is full drops the message and counts it rather than wait
+const int LOG_MAX_THREADS = 32;
+const int LOG_RING_RECORDS = 512;
+const int LOG_MAX_ARGS = 8;
+// String arguments are copied into the record, cut off past this
+const int LOG_TEXT_BYTES = 160;
+// How often the writer thread wakes to drain the rings
+const int LOG_FLUSH_MS = 10;
+
+//enum
+enum class LogCategory {
+    CORE,
+    ASSETS,
+    RENDER,
+    JOBS,
+    PERF,
+    COUNT
+};
+
+enum class LogArgType : Uint8 {
+    INT,
+    UINT,
+    DOUBLE,
+    STRING,                   // args holds the offset into text
+    POINTER
+};
+
+//structure
+// One message as the writer thread gets it. Nothing is formatted on the
+// logging thread: format is a string literal whose address identifies the
+// message, and its {} placeholders are filled from args when written.
+struct LogRecord {
+    const char* format;
+    Uint64 time;              // SDL_GetPerformanceCounter
+    Uint8 level;
+    LogCategory category;
+    Uint8 argCount;
+    Uint8 textUsed;
+    LogArgType types[LOG_MAX_ARGS];
+    Uint64 args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_BYTES];
+};
+
+//function definaction
+// Start the writer thread. Before this and after shutdownLog, messages are
+// formatted and written on the calling thread.
+bool initLog();
+// Write everything logged so far and stop the writer
+void shutdownLog();
+// Messages dropped because a ring was full
+Uint64 logDropped();
+
+// Claim the calling thread's next record, or NULL if its ring is full. The
+// first call on a thread claims one of the rings initLog made.
+LogRecord* logBegin(int level, LogCategory category, const char* format);
+void logCommit(LogRecord* record);
+
+inline void logArg(LogRecord& r, LogArgType type, Uint64 value) {
+    if (r.argCount == LOG_MAX_ARGS) return;
+    r.types[r.argCount] = type;
+    r.args[r.argCount++] = value;
+}
+
+inline void logArg(LogRecord& r, int v) { logArg(r, LogArgType::INT, static_cast<Uint64>(static_cast<Sint64>(v))); }
+inline void logArg(LogRecord& r, long v) { logArg(r, LogArgType::INT, static_cast<Uint64>(static_cast<Sint64>(v))); }
+inline void logArg(LogRecord& r, long long v) { logArg(r, LogArgType::INT, static_cast<Uint64>(v)); }
+inline void logArg(LogRecord& r, unsigned v) { logArg(r, LogArgType::UINT, v); }
+inline void logArg(LogRecord& r, unsigned long v) { logArg(r, LogArgType::UINT, v); }
+inline void logArg(LogRecord& r, unsigned long long v) { logArg(r, LogArgType::UINT, v); }
+inline void logArg(LogRecord& r, bool v) { logArg(r, LogArgType::UINT, v ? 1 : 0); }
+
+inline void logArg(LogRecord& r, double v) {
+    Uint64 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    logArg(r, LogArgType::DOUBLE, bits);
+}
+
+inline void logArg(LogRecord& r, const void* p) {
+    logArg(r, LogArgType::POINTER, static_cast<Uint64>(reinterpret_cast<std::size_t>(p)));
+}
+
+// Strings are copied: SDL_GetError and friends reuse their buffers
+inline void logArg(LogRecord& r, const char* s) {
+    if (!s) s = "(null)";
+    int start = r.textUsed;
+    int n = 0;
+    while (s[n] && start + n < LOG_TEXT_BYTES - 1) {
+        r.text[start + n] = s[n];
+        n++;
+    }
+    r.text[start + n] = 0;
+    r.textUsed = static_cast<Uint8>(start + n + (start + n < LOG_TEXT_BYTES - 1 ? 1 : 0));
+    logArg(r, LogArgType::STRING, static_cast<Uint64>(start));
+}
+
+template <typename... Args>
+void logWrite(int level, LogCategory category, const char* format, const Args&... args) {
+    LogRecord* record = logBegin(level, category, format);
+    if (!record) return;
+    (logArg(*record, args), ...);
+    logCommit(record);
+}
+
+// LOG_ERROR(LogCategory::RENDER, "Failed to create layer: {}", SDL_GetError());
+// Arguments are not evaluated when the level or category is compiled out.
+#define LOG_ENABLED(level, category) \
+    ((level) >= LOG_MIN_LEVEL && ((LOG_CATEGORIES >> static_cast<int>(category)) & 1u))
+#define LOG_AT(level, category, ...) \
+    do { \
+        if constexpr (LOG_ENABLED(level, category)) logWrite(level, category, __VA_ARGS__); \
+    } while (0)
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOG_WARN(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
@@ -2,11 +2,133 @@
 #include "SDL2/SDL_image.h"
 #include <iostream>
 #include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
 #include "settings.h"
+#include "latency.h"
+#include "bench.h"
 
+// Parse command-line flags; false on anything unrecognised
+static bool parseOptions(int argc, char* argv[], Options& options) {
+    options = Options{};
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--latency") == 0) {
+            options.measureLatency = true;
+        }
+        else if (strcmp(argv[i], "--inject") == 0 && hasValue) {
+            options.injectInterval = atoi(argv[++i]);
+            options.measureLatency = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.maxFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--deterministic") == 0) {
+            options.deterministic = true;
+        }
+        else if (strcmp(argv[i], "--bench-jobs") == 0) {
+            options.benchJobs = true;
+        }
+        else if (strcmp(argv[i], "--stress-projectiles") == 0 && hasValue) {
+            options.stressProjectiles = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--internal-res") == 0 && hasValue &&
+                 sscanf(argv[i + 1], "%dx%d", &options.internalW, &options.internalH) == 2) {
+            i++;
+        }
+        else if (strcmp(argv[i], "--dynamic-res") == 0) {
+            options.dynamicResolution = true;
+        }
+        else if (strcmp(argv[i], "--telemetry") == 0 && hasValue) {
+            options.telemetryPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--backend") == 0 && hasValue &&
+                 parseBackendType(argv[i + 1], options.backend)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "--bench-render") == 0) {
+            options.benchRender = true;
+        }
+        else if (strcmp(argv[i], "--bench-blit") == 0) {
+            options.benchBlit = true;
+        }
+        else if (strcmp(argv[i], "--bench-raster") == 0) {
+            options.benchRaster = true;
+        }
+        else if (strcmp(argv[i], "--dirty-rects") == 0) {
+            options.dirtyRects = true;
+        }
+        else if (strcmp(argv[i], "--bench-text") == 0) {
+            options.benchText = true;
+        }
+        else if (strcmp(argv[i], "--overlay") == 0) {
+            options.overlay = true;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options.traceFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--trace-file") == 0 && hasValue) {
+            options.tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--sample") == 0) {
+            // The rate is optional
+            options.sampleHz = hasValue && isdigit(static_cast<unsigned char>(argv[i + 1][0]))
+                                   ? atoi(argv[++i]) : SAMPLER_DEFAULT_HZ;
+        }
+        else if (strcmp(argv[i], "--sample-file") == 0 && hasValue) {
+            options.samplePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--perf-counters") == 0) {
+            options.perfCounters = true;
+        }
+        else if (strcmp(argv[i], "--assert-no-alloc") == 0) {
+            // The warm-up is optional
+            options.assertNoAlloc = true;
+            if (hasValue && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                options.allocWarmup = atoi(argv[++i]);
+            }
+        }
+        else if (strcmp(argv[i], "--alloc-report") == 0) {
+            options.allocReport = true;
+        }
+        else if (strcmp(argv[i], "--arena-kb") == 0 && hasValue) {
+            options.arenaKB = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--huge-pages") == 0) {
+            options.hugePages = true;
+        }
+        else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--latency] [--inject FRAMES] [--frames N]"
+                         " [--threads N] [--deterministic] [--bench-jobs]"
+                         " [--stress-projectiles N] [--internal-res WxH] [--dynamic-res]"
+                         " [--telemetry FILE] [--backend renderer|software|surface|null|auto]"
+                         " [--bench-render] [--bench-blit] [--bench-raster] [--dirty-rects] [--bench-text] [--overlay]"
+                         " [--trace N] [--trace-file FILE] [--sample [HZ]] [--sample-file FILE]"
+                         " [--perf-counters] [--assert-no-alloc [WARMUP]] [--alloc-report]"
+                         " [--arena-kb N] [--huge-pages]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
 int main(int argc, char* argv[]) {
-    Game game;
+    Game game{};
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+    // Every later return flushes the log through atexit
+    if (initLog()) atexit(shutdownLog);
+
+    if (options.benchJobs) {
+        runJobBenchmark(options.threads);
+        return 0;
+    }
     
     // Initialize everything
     if (!initSDL(game)) return 1;
@@ -14,48 +136,229 @@ int main(int argc, char* argv[]) {
         cleanup(game);
         return 1;
     }
+    if (options.benchRender || options.benchBlit || options.benchRaster || options.benchText) {
+        if (options.benchBlit) runBlitBenchmark(game.atlas, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (options.benchRaster) runRasterBenchmark(game.atlas, options.threads, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (options.benchText) runTextBenchmark(game.font, game.atlas);
+        if (options.benchRender && initJobSystem(game.jobs, options.threads, options.deterministic)) {
+            runRenderBenchmark(game.window, game.atlas, game.jobs, SCREEN_WIDTH, SCREEN_HEIGHT);
+            shutdownJobSystem(game.jobs);
+        }
+        cleanup(game);
+        return 0;
+    }
     initGame(game);
+    game.stressProjectiles = options.stressProjectiles;
+    if (options.dynamicResolution) {
+        // The target is the window size (or --internal-res, as an upper bound)
+        // and the controller picks how much of it to use
+        int w = options.internalW > 0 ? options.internalW : SCREEN_WIDTH;
+        int h = options.internalH > 0 ? options.internalH : SCREEN_HEIGHT;
+        initSceneTarget(game.scene, w, h, false);
+        initResolutionController(game.resolution, DYNRES_MIN, DYNRES_MAX, RENDER_BUDGET_MS);
+    }
+    else if (options.internalW > 0 && options.internalH > 0) {
+        initSceneTarget(game.scene, options.internalW, options.internalH, true);
+    }
+
+    // Counters only follow threads started after they open, so open them
+    // before the workers
+    PerfCounters perf = {{-1, -1, -1, -1, -1, -1, -1}, false, false};
+    if (options.perfCounters && !initPerfCounters(perf)) {
+        LOG_WARN(LogCategory::PERF, "Performance counters disabled");
+    }
+
+    if (!initJobSystem(game.jobs, options.threads, options.deterministic)) {
+        closePerfCounters(perf);
+        cleanup(game);
+        return 1;
+    }
+
+    // One arena per job thread, the main thread included
+    if (options.arenaKB > 0 &&
+        !initFrameArenas(game.jobs.activeWorkers, options.arenaKB * 1024u, options.hugePages)) {
+        LOG_WARN(LogCategory::CORE, "Some threads have no frame arena and will use the heap");
+    }
+
+    // Pick a backend, falling back through the others if it won't start.
+    // Either scene mode falls back to drawing straight to the window if the
+    // backend can't provide a target.
+    BackendType backend = options.backend;
+    if (backend == BackendType::AUTO) {
+        backend = probeBackend(game.window, game.atlas, game.scene, &game.jobs, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+    if (!initBackendFallback(game.backend, backend, game.window, game.atlas, game.scene, &game.jobs)) {
+        shutdownJobSystem(game.jobs);
+        cleanup(game);
+        return 1;
+    }
+    game.dynamicResolution = options.dynamicResolution && game.scene.width > 0;
+    if (options.dirtyRects) setBackendDirtyRects(game.backend, true, game.scene);
+    game.overlay.visible = options.overlay;
+    if (!initHudLayer(game.hud, game.backend, game.atlas)) {
+        LOG_WARN(LogCategory::RENDER, "HUD disabled");
+    }
+
+    static LatencyTracker latency;
+    initLatencyTracker(latency, options.injectInterval);
+
+    Telemetry telemetry = {NULL, false, false};
+    if (options.telemetryPath) {
+        openTelemetry(telemetry, options.telemetryPath, perf);
+    }
     
+    profilerThreadName("main");
+    allocationThreadName("main");
+    int traceFrames = options.traceFrames > 0 ? options.traceFrames : PROFILE_DEFAULT_FRAMES;
+    if (options.traceFrames > 0) {
+        profilerStartCapture(traceFrames, options.tracePath);
+    }
+
+    if (options.sampleHz > 0) {
+        startSampler(options.sampleHz, options.samplePath);
+    }
+
     // Main game loop
     bool running = true;
     Uint32 lastTime = SDL_GetTicks();
+    Uint32 frame = 0;
+    PerfSample perfMark;
+    static PhaseReport phaseReport;
+    // Frame start for --assert-no-alloc, loop start for --alloc-report
+    static AllocationSnapshot frameHeap, loopHeap;
+    takeAllocationSnapshot(loopHeap);
     
     while (running) {
         // Calculate delta time
         Uint32 currentTime = SDL_GetTicks();
         double deltaTime = currentTime - lastTime;
         lastTime = currentTime;
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        AllocationCounters heapStart = allocationCounters();
+        if (options.assertNoAlloc) takeAllocationSnapshot(frameHeap);
+        FrameStats& stats = game.stats;
+        stats.frame = frame;
         
-        // Event handling
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = false;
-            }
-            else if (event.type == SDL_KEYDOWN) {
-                if (event.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
-                    running = false;
-                }
-            }
+        // Sample input as late as possible before the sim step
+        Uint64 phaseStart = SDL_GetPerformanceCounter();
+        readPerfCounters(perf, perfMark);
+        pollInput(game.input);
+        if (game.input.quit) {
+            running = false;
+        }
+        // The OS dropped the window's contents; dirty rects can't trust them
+        if (game.input.exposed) {
+            backendInvalidate(game.backend);
+            game.input.exposed = false;
+        }
+        // A device reset (Direct3D) wipes target textures, the HUD layer included
+        if (game.input.targetsReset) {
+            game.hud.dirty = true;
+            backendInvalidate(game.backend);
+            game.input.targetsReset = false;
+        }
+        if (game.input.overlayToggled) {
+            game.overlay.visible = !game.overlay.visible;
+            game.input.overlayToggled = false;
+        }
+        if (game.input.captureRequested) {
+            profilerStartCapture(traceFrames, options.tracePath);
+            game.input.captureRequested = false;
         }
-        
-        // Get keyboard state
-        const Uint8* keys = SDL_GetKeyboardState(NULL);
         
         // Handle input
-        handleInput(game, keys);
+        handleInput(game, consumeInput(game.input));
+        if (options.measureLatency) {
+            latencyOnTick(latency, game.input, frame);
+        }
+        stats.phaseMs[static_cast<int>(Phase::INPUT)] = elapsedMs(phaseStart);
+        perfCountersSince(perf, perfMark, stats.phaseEvents[static_cast<int>(Phase::INPUT)]);
         
         // Update game state
+        phaseStart = SDL_GetPerformanceCounter();
         updateGame(game, deltaTime);
+        stats.phaseMs[static_cast<int>(Phase::UPDATE)] = elapsedMs(phaseStart);
+        perfCountersSince(perf, perfMark, stats.phaseEvents[static_cast<int>(Phase::UPDATE)]);
         
         // Render game
+        phaseStart = SDL_GetPerformanceCounter();
         renderGame(game);
+        stats.phaseMs[static_cast<int>(Phase::RENDER)] = elapsedMs(phaseStart);
+        perfCountersSince(perf, perfMark, stats.phaseEvents[static_cast<int>(Phase::RENDER)]);
+
+        phaseStart = SDL_GetPerformanceCounter();
+        presentGame(game);
+        stats.phaseMs[static_cast<int>(Phase::PRESENT)] = elapsedMs(phaseStart);
+        perfCountersSince(perf, perfMark, stats.phaseEvents[static_cast<int>(Phase::PRESENT)]);
+        if (options.measureLatency) {
+            latencyOnPresent(latency, frame, SDL_GetTicks());
+        }
+        // Synthetic input for automated latency runs, queued right after the
+        // present so it waits out the frame gap like a real key press
+        latencyInject(latency, frame);
+
+        // Resize the scene target for the next frame from this one's cost
+        if (game.dynamicResolution) {
+            updateResolution(game.resolution, static_cast<float>(stats.phaseMs[static_cast<int>(Phase::RENDER)]));
+        }
+        stats.frameMs = elapsedMs(frameStart);
+        AllocationCounters heapEnd = allocationCounters();
+        stats.allocations = static_cast<int>(heapEnd.allocations - heapStart.allocations);
+        stats.allocatedBytes = static_cast<int>(heapEnd.bytes - heapStart.bytes);
+        stats.arenaBytes = static_cast<int>(frameArenaStats().used);
+        // Past warm-up the loop must not touch the heap. Capture frames are
+        // exempt: arming one makes its buffers and the last writes the file.
+        if (options.assertNoAlloc && stats.allocations > 0 && frame >= static_cast<Uint32>(options.allocWarmup) &&
+            !profilerCapturing()) {
+            shutdownLog();
+            std::cerr << "Frame " << frame << " allocated " << stats.allocations << " times ("
+                      << stats.allocatedBytes << " bytes) after warm-up:" << std::endl;
+            printAllocationReport(frameHeap, std::cerr);
+            abort();
+        }
+        writeTelemetry(telemetry, stats);
+        recordOverlayFrame(game.overlay, stats);
+        if (perf.hardware || perf.software) addPhaseReport(phaseReport, stats);
+        profilerEndFrame();
+        // Every job has finished, so nothing still points into the arenas
+        resetFrameArenas();
+
+        frame++;
+        if (options.maxFrames && frame >= static_cast<Uint32>(options.maxFrames)) {
+            running = false;
+        }
         
         // Cap frame rate
         SDL_Delay(16); // ~60 FPS
     }
     
+    if (options.measureLatency) {
+        printLatencyReport(latency);
+    }
+    LOG_INFO(LogCategory::RENDER, "HUD: {} redraws over {} frames ({} value changes)", game.hud.redraws,
+             game.hud.frames, game.hud.changes);
+    if (perf.hardware || perf.software) {
+        printPhaseReport(phaseReport, perf);
+    }
+    FrameArenaStats arena = frameArenaStats();
+    if (arena.capacity > 0) {
+        std::cout << "Frame arenas: " << arena.threads << " threads used, high water " << arena.highWater << " of "
+                  << arena.capacity << " bytes" << (arena.hugePages ? " (huge pages)" : "") << ", "
+                  << arena.overflows << " overflows" << std::endl;
+    }
+    if (options.allocReport) {
+        std::cout << "Heap traffic over " << frame << " frames:" << std::endl;
+        printAllocationReport(loopHeap, std::cout);
+    }
+
     // Cleanup
+    closeTelemetry(telemetry);
+    shutdownJobSystem(game.jobs);
+    profilerShutdown();
+    // After the workers have exited, so no handler is mid-sample on them
+    stopSampler();
+    destroyFrameArenas();
+    closePerfCounters(perf);
     cleanup(game);
     return 0;
 }
@@ -0,0 +1,223 @@
+#include "memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <vector>
+
+#if defined(MEMORY_TRACK_SITES) && defined(__linux__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+// Sites printed by printAllocationReport
+static const int MEMORY_REPORT_SITES = 10;
+// Slots probed for a site before it counts as unknown
+static const int MEMORY_SITE_PROBES = 16;
+
+// One writer per slot except the shared overflow slot, so these are plain
+// relaxed counters. Everything here is zero before any constructor runs,
+// which matters because new is called during static initialisation.
+struct ThreadCounters {
+    std::atomic<Uint64> allocations;
+    std::atomic<Uint64> frees;
+    std::atomic<Uint64> bytes;
+    char name[32];
+};
+
+static ThreadCounters threadCounters[MEMORY_MAX_THREADS];
+static std::atomic<int> threadCount(0);
+static thread_local ThreadCounters* currentThread = NULL;
+
+static ThreadCounters& threadSlot() {
+    if (!currentThread) {
+        int index = threadCount.fetch_add(1, std::memory_order_relaxed);
+        currentThread = &threadCounters[std::min(index, MEMORY_MAX_THREADS - 1)];
+    }
+    return *currentThread;
+}
+
+#ifdef MEMORY_TRACK_SITES
+struct SiteCounters {
+    std::atomic<void*> caller;    // NULL = free slot; never changes once set
+    std::atomic<Uint64> allocations;
+    std::atomic<Uint64> bytes;
+};
+
+static SiteCounters sites[MEMORY_MAX_SITES + 1];
+
+static void countSite(void* caller, std::size_t size) {
+    std::size_t slot = (reinterpret_cast<std::uintptr_t>(caller) >> 2) * 0x9e3779b97f4a7c15ull >> 20;
+    SiteCounters* site = &sites[MEMORY_MAX_SITES];
+    for (int probe = 0; probe < MEMORY_SITE_PROBES; probe++) {
+        SiteCounters& s = sites[(slot + probe) & (MEMORY_MAX_SITES - 1)];
+        void* current = s.caller.load(std::memory_order_acquire);
+        if (!current && s.caller.compare_exchange_strong(current, caller, std::memory_order_acq_rel)) {
+            current = caller;
+        }
+        if (current == caller) {
+            site = &s;
+            break;
+        }
+    }
+    site->allocations.fetch_add(1, std::memory_order_relaxed);
+    site->bytes.fetch_add(size, std::memory_order_relaxed);
+}
+#endif
+
+AllocationCounters allocationCounters() {
+    AllocationCounters total = {0, 0, 0};
+    int threads = std::min(threadCount.load(std::memory_order_relaxed), MEMORY_MAX_THREADS);
+    for (int i = 0; i < threads; i++) {
+        total.allocations += threadCounters[i].allocations.load(std::memory_order_relaxed);
+        total.frees += threadCounters[i].frees.load(std::memory_order_relaxed);
+        total.bytes += threadCounters[i].bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void allocationThreadName(const char* name) {
+    snprintf(threadSlot().name, sizeof(threadCounters[0].name), "%s", name);
+}
+
+void takeAllocationSnapshot(AllocationSnapshot& snapshot) {
+    snapshot.threads = std::min(threadCount.load(std::memory_order_relaxed), MEMORY_MAX_THREADS);
+    for (int i = 0; i < snapshot.threads; i++) {
+        snapshot.thread[i] = {threadCounters[i].allocations.load(std::memory_order_relaxed),
+                              threadCounters[i].frees.load(std::memory_order_relaxed),
+                              threadCounters[i].bytes.load(std::memory_order_relaxed)};
+    }
+#ifdef MEMORY_TRACK_SITES
+    for (int i = 0; i <= MEMORY_MAX_SITES; i++) {
+        snapshot.siteAllocations[i] = sites[i].allocations.load(std::memory_order_relaxed);
+        snapshot.siteBytes[i] = sites[i].bytes.load(std::memory_order_relaxed);
+    }
+#endif
+}
+
+#ifdef MEMORY_TRACK_SITES
+// Function containing address, demangled where the symbol is exported
+static void printSite(std::ostream& out, void* address) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%p", address);
+    out << buffer;
+#ifdef __linux__
+    Dl_info info;
+    if (dladdr(address, &info) && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+        out << " " << (status == 0 && demangled ? demangled : info.dli_sname);
+        free(demangled);
+    }
+#endif
+}
+#endif
+
+void printAllocationReport(const AllocationSnapshot& since, std::ostream& out) {
+    AllocationSnapshot now;
+    takeAllocationSnapshot(now);
+    for (int i = 0; i < now.threads; i++) {
+        AllocationCounters before = i < since.threads ? since.thread[i] : AllocationCounters{0, 0, 0};
+        Uint64 allocations = now.thread[i].allocations - before.allocations;
+        Uint64 frees = now.thread[i].frees - before.frees;
+        if (allocations == 0 && frees == 0) continue;
+        const char* name = threadCounters[i].name[0] ? threadCounters[i].name : "unnamed";
+        out << "  thread " << i << " (" << name << "): " << allocations << " allocations ("
+            << now.thread[i].bytes - before.bytes << " bytes), " << frees << " frees" << std::endl;
+    }
+
+#ifdef MEMORY_TRACK_SITES
+    std::vector<int> busiest;
+    for (int i = 0; i <= MEMORY_MAX_SITES; i++) {
+        if (now.siteAllocations[i] != since.siteAllocations[i]) busiest.push_back(i);
+    }
+    std::sort(busiest.begin(), busiest.end(), [&](int a, int b) {
+        return now.siteAllocations[a] - since.siteAllocations[a] > now.siteAllocations[b] - since.siteAllocations[b];
+    });
+    if (busiest.size() > static_cast<std::size_t>(MEMORY_REPORT_SITES)) busiest.resize(MEMORY_REPORT_SITES);
+    for (int i : busiest) {
+        out << "  " << now.siteAllocations[i] - since.siteAllocations[i] << " allocations ("
+            << now.siteBytes[i] - since.siteBytes[i] << " bytes) from ";
+        if (i == MEMORY_MAX_SITES) {
+            out << "unknown sites";
+        } else {
+            printSite(out, sites[i].caller.load(std::memory_order_relaxed));
+        }
+        out << std::endl;
+    }
+#endif
+}
+
+static void* countedAlloc(std::size_t size, void* caller) {
+    ThreadCounters& counters = threadSlot();
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef MEMORY_TRACK_SITES
+    countSite(caller, size);
+#else
+    (void)caller;
+#endif
+    return std::malloc(size ? size : 1);
+}
+
+static void countedFree(void* p) {
+    if (!p) return;
+    threadSlot().frees.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+
+#ifdef __GNUC__
+#define ALLOCATION_CALLER __builtin_return_address(0)
+#else
+#define ALLOCATION_CALLER NULL
+#endif
+
+// Replacements for the global allocation functions; every new in the
+// program, the standard library's included, comes through here
+void* operator new(std::size_t size) {
+    void* p = countedAlloc(size, ALLOCATION_CALLER);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = countedAlloc(size, ALLOCATION_CALLER);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, ALLOCATION_CALLER);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, ALLOCATION_CALLER);
+}
+
+void operator delete(void* p) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void* p) noexcept {
+    countedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    countedFree(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    countedFree(p);
+}
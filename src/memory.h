@@ -0,0 +1,46 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <iosfwd>
+
+// Threads with their own counters; later threads share the last slot
+const int MEMORY_MAX_THREADS = 32;
+// Debug builds attribute allocations to the code that called new. Sites are
+// hashed into this many slots (a power of two); ones that don't fit are
+// counted as unknown.
+#if !defined(NDEBUG) && defined(__GNUC__)
+#define MEMORY_TRACK_SITES 1
+const int MEMORY_MAX_SITES = 4096;
+#else
+const int MEMORY_MAX_SITES = 0;
+#endif
+// --assert-no-alloc skips this many frames while caches and pools fill
+const int MEMORY_WARMUP_FRAMES = 120;
+
+//structure
+// Heap traffic through the global operator new/delete since startup
+struct AllocationCounters {
+    Uint64 allocations;
+    Uint64 frees;
+    Uint64 bytes;             // Requested by allocations
+};
+
+// Every thread's counters, and with MEMORY_TRACK_SITES every call site's, at
+// one moment; reports cover what happened after it
+struct AllocationSnapshot {
+    int threads;
+    AllocationCounters thread[MEMORY_MAX_THREADS];
+#ifdef MEMORY_TRACK_SITES
+    Uint64 siteAllocations[MEMORY_MAX_SITES + 1];   // The last is unknown sites
+    Uint64 siteBytes[MEMORY_MAX_SITES + 1];
+#endif
+};
+
+//function definaction
+// Totals over all threads
+AllocationCounters allocationCounters();
+// Label the calling thread's counters in reports
+void allocationThreadName(const char* name);
+void takeAllocationSnapshot(AllocationSnapshot& snapshot);
+// Per-thread traffic since snapshot, then the busiest call sites when they
+// are tracked. Allocates, so keep it out of measured frames.
+void printAllocationReport(const AllocationSnapshot& since, std::ostream& out);
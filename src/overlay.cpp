@@ -0,0 +1,124 @@
+#include "overlay.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static const int OVERLAY_WIDTH = 212;
+static const int OVERLAY_MARGIN = 8;
+static const int OVERLAY_PADDING = 4;
+static const int OVERLAY_GRAPH_H = 40;
+static const float OVERLAY_BAR_PX_PER_MS = 20.0f;
+static const float OVERLAY_BAR_MAX = 110.0f;
+// Graph bars, budget line, panel and one bar per phase
+static const int OVERLAY_MAX_QUADS = OVERLAY_HISTORY + 2 + static_cast<int>(Phase::COUNT);
+
+static const SDL_Color OVERLAY_PANEL = {0, 0, 0, 170};
+static const SDL_Color OVERLAY_TEXT = {230, 230, 230, 255};
+static const SDL_Color OVERLAY_BUDGET = {255, 255, 255, 120};
+static const SDL_Color OVERLAY_PHASE[] = {
+    {90, 160, 255, 255},      // input
+    {100, 220, 120, 255},     // update
+    {255, 170, 60, 255},      // render
+    {200, 120, 255, 255},     // present
+};
+
+bool loadOverlay(PerfOverlay& overlay, Atlas& atlas) {
+    overlay.solidRegion = atlasAddSolid(atlas, 4, 0xffffff);
+    overlay.head = 0;
+    overlay.count = 0;
+    overlay.last = FrameStats{};
+    overlay.buildMs = 0;
+    return overlay.solidRegion >= 0;
+}
+
+void recordOverlayFrame(PerfOverlay& overlay, const FrameStats& stats) {
+    overlay.frameMs[overlay.head] = static_cast<float>(stats.frameMs);
+    overlay.head = (overlay.head + 1) % OVERLAY_HISTORY;
+    overlay.count = std::min(overlay.count + 1, OVERLAY_HISTORY);
+    overlay.last = stats;
+}
+
+// Flat quad from the centre of the solid region, so filtering never
+// reaches its edge
+static void solidQuad(SDL_Vertex* q, const SDL_FRect& uv, float x0, float y0, float x1, float y1, SDL_Color c) {
+    q[0] = {{x0, y0}, c, {uv.x, uv.y}};
+    q[1] = {{x1, y0}, c, {uv.x + uv.w, uv.y}};
+    q[2] = {{x1, y1}, c, {uv.x + uv.w, uv.y + uv.h}};
+    q[3] = {{x0, y1}, c, {uv.x, uv.y + uv.h}};
+}
+
+static SDL_Color frameColor(float ms) {
+    if (ms <= OVERLAY_BUDGET_MS) return {100, 220, 120, 255};
+    if (ms <= OVERLAY_BUDGET_MS * 2) return {240, 210, 70, 255};
+    return {240, 80, 60, 255};
+}
+
+void buildOverlay(PerfOverlay& overlay, DrawList& list, TextCache& text, const Font& font, const Atlas& atlas,
+                  int logicalW) {
+    if (!overlay.visible) return;
+    Uint64 start = SDL_GetPerformanceCounter();
+    const FrameStats& s = overlay.last;
+
+    const int phases = static_cast<int>(Phase::COUNT);
+    const float lineH = static_cast<float>(FONT_LINE);
+    float x0 = static_cast<float>(logicalW - OVERLAY_WIDTH - OVERLAY_MARGIN);
+    float y0 = static_cast<float>(OVERLAY_MARGIN);
+    float left = x0 + OVERLAY_PADDING;
+    float graphY = y0 + OVERLAY_PADDING + lineH;
+    float phaseY = graphY + OVERLAY_GRAPH_H + OVERLAY_PADDING;
+    float countersY = phaseY + phases * lineH + OVERLAY_PADDING;
+    float height = countersY + 4 * lineH + OVERLAY_PADDING - y0;
+
+    SDL_Vertex* out = beginQuads(list, OVERLAY_MAX_QUADS);
+    if (!out) return;
+    const SDL_Rect& r = atlas.regions[overlay.solidRegion].rect;
+    SDL_FRect uv = {(r.x + 1.0f) / atlas.width, (r.y + 1.0f) / atlas.height,
+                    (r.w - 2.0f) / atlas.width, (r.h - 2.0f) / atlas.height};
+    int quads = 0;
+    solidQuad(&out[quads++ * 4], uv, x0, y0, x0 + OVERLAY_WIDTH, y0 + height, OVERLAY_PANEL);
+
+    // Frame times, oldest on the left, clipped at the top of the graph
+    float barW = static_cast<float>(OVERLAY_WIDTH - 2 * OVERLAY_PADDING) / OVERLAY_HISTORY;
+    float graphBottom = graphY + OVERLAY_GRAPH_H;
+    float pxPerMs = OVERLAY_GRAPH_H / OVERLAY_GRAPH_MS;
+    int oldest = overlay.count < OVERLAY_HISTORY ? 0 : overlay.head;
+    for (int i = 0; i < overlay.count; i++) {
+        float ms = overlay.frameMs[(oldest + i) % OVERLAY_HISTORY];
+        float h = std::min(ms * pxPerMs, static_cast<float>(OVERLAY_GRAPH_H));
+        float x = left + (OVERLAY_HISTORY - overlay.count + i) * barW;
+        solidQuad(&out[quads++ * 4], uv, x, graphBottom - h, x + barW, graphBottom, frameColor(ms));
+    }
+    float budgetY = graphBottom - OVERLAY_BUDGET_MS * pxPerMs;
+    solidQuad(&out[quads++ * 4], uv, left, budgetY, x0 + OVERLAY_WIDTH - OVERLAY_PADDING, budgetY + 1,
+              OVERLAY_BUDGET);
+
+    // One bar per phase, after its label
+    float barX = left + 15 * FONT_ADVANCE;
+    for (int p = 0; p < phases; p++) {
+        float w = std::min(static_cast<float>(s.phaseMs[p]) * OVERLAY_BAR_PX_PER_MS, OVERLAY_BAR_MAX);
+        float y = phaseY + p * lineH;
+        solidQuad(&out[quads++ * 4], uv, barX, y, barX + std::max(w, 1.0f), y + FONT_GLYPH_H, OVERLAY_PHASE[p]);
+    }
+    endQuads(list, quads);
+
+    // Text goes over the quads
+    char line[TEXT_MAX_LENGTH];
+    snprintf(line, sizeof(line), "frame %6.2f ms %5.0f fps", s.frameMs, s.frameMs > 0 ? 1000.0 / s.frameMs : 0.0);
+    drawText(list, text, font, atlas, line, left, y0 + OVERLAY_PADDING, 1, OVERLAY_TEXT);
+    for (int p = 0; p < phases; p++) {
+        snprintf(line, sizeof(line), "%-7s %5.2f", phaseName(static_cast<Phase>(p)), s.phaseMs[p]);
+        drawText(list, text, font, atlas, line, left, phaseY + p * lineH, 1, OVERLAY_TEXT);
+    }
+    snprintf(line, sizeof(line), "draws %d sprites %d quads %d", s.drawCommands, s.sprites, s.quads);
+    drawText(list, text, font, atlas, line, left, countersY, 1, OVERLAY_TEXT);
+    snprintf(line, sizeof(line), "entities %d (%d shots, %d fx)", 1 + s.projectiles + s.particles,
+             s.projectiles, s.particles);
+    drawText(list, text, font, atlas, line, left, countersY + lineH, 1, OVERLAY_TEXT);
+    snprintf(line, sizeof(line), "allocs %d (%d bytes) arena %dk", s.allocations, s.allocatedBytes,
+             (s.arenaBytes + 1023) / 1024);
+    drawText(list, text, font, atlas, line, left, countersY + 2 * lineH, 1, OVERLAY_TEXT);
+    snprintf(line, sizeof(line), "overlay %.3f ms", overlay.buildMs);
+    drawText(list, text, font, atlas, line, left, countersY + 3 * lineH, 1, OVERLAY_TEXT);
+
+    overlay.buildMs = elapsedMs(start);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "render.h"
+#include "telemetry.h"
+#include "text.h"
+
+// Frames the frame-time graph scrolls through
+const int OVERLAY_HISTORY = 128;
+// The graph's full height, and the line drawn across it (ms)
+const float OVERLAY_GRAPH_MS = 33.3f;
+const float OVERLAY_BUDGET_MS = 16.7f;
+
+//structure
+// Performance overlay appended to the frame's draw list: frame-time graph,
+// per-phase bars and counters, all from the last completed frame
+struct PerfOverlay {
+    bool visible;
+    int solidRegion;
+    float frameMs[OVERLAY_HISTORY];   // Ring, oldest at head once full
+    int head, count;
+    FrameStats last;
+    double buildMs;           // What the last buildOverlay cost
+};
+
+//function definaction
+// Add the overlay's solid fill to the atlas; call before finalizeAtlas
+bool loadOverlay(PerfOverlay& overlay, Atlas& atlas);
+// Feed a completed frame's stats; call once per frame, visible or not
+void recordOverlayFrame(PerfOverlay& overlay, const FrameStats& stats);
+// Append the overlay to list, in the top-right of a logicalW wide screen:
+// one quad batch for the panel, graph and bars plus one per line of text.
+// Does nothing when hidden.
+void buildOverlay(PerfOverlay& overlay, DrawList& list, TextCache& text, const Font& font, const Atlas& atlas,
+                  int logicalW);
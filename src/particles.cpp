@@ -0,0 +1,228 @@
+#include "particles.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool initParticles(ParticleSystem& system) {
+    std::vector<float>* floats[] = {
+        &system.x, &system.y, &system.vx, &system.vy, &system.age, &system.life,
+        &system.gravity, &system.sizeStart, &system.sizeEnd, &system.size
+    };
+    for (std::vector<float>* f : floats) f->assign(PARTICLE_CAPACITY, 0);
+    system.colorStart.assign(PARTICLE_CAPACITY, 0);
+    system.colorEnd.assign(PARTICLE_CAPACITY, 0);
+    system.color.assign(PARTICLE_CAPACITY, 0);
+    system.region.assign(PARTICLE_CAPACITY, 0);
+    clearPool(system.emitters);
+    reservePool(system.emitters, PARTICLE_MAX_EMITTERS);
+    system.rng = 0x2545f491u;
+    clearParticles(system);
+    return true;
+}
+
+void clearParticles(ParticleSystem& system) {
+    system.head = 0;
+    system.used = 0;
+    system.budget = PARTICLE_BUDGET_PER_FRAME;
+    system.tickSpawned = 0;
+    system.tickThrottled = 0;
+    system.alive = 0;
+    system.spawned = 0;
+    system.throttled = 0;
+}
+
+PoolHandle createEmitter(ParticleSystem& system, const EmitterParams& params) {
+    return poolCreate(system.emitters, Emitter{params, 0, 0, 0, false});
+}
+
+void destroyEmitter(ParticleSystem& system, PoolHandle emitter) {
+    poolDestroy(system.emitters, emitter);
+}
+
+void moveEmitter(ParticleSystem& system, PoolHandle emitter, float x, float y) {
+    Emitter* e = poolGet(system.emitters, emitter);
+    if (!e) return;
+    e->x = x;
+    e->y = y;
+}
+
+void setEmitterActive(ParticleSystem& system, PoolHandle emitter, bool active) {
+    Emitter* e = poolGet(system.emitters, emitter);
+    if (e) e->active = active;
+}
+
+void setEmitterAngle(ParticleSystem& system, PoolHandle emitter, float angle) {
+    Emitter* e = poolGet(system.emitters, emitter);
+    if (e) e->params.angle = angle;
+}
+
+static Uint32 packColor(SDL_Color c) {
+    Uint32 packed;
+    memcpy(&packed, &c, sizeof(packed));
+    return packed;
+}
+
+static int spawn(ParticleSystem& system, const EmitterParams& p, float x, float y, int count) {
+    int granted = std::min(count, system.budget);
+    system.budget -= granted;
+    system.tickThrottled += count - granted;
+    system.tickSpawned += granted;
+
+    for (int n = 0; n < granted; n++) {
+        int i = system.head;
+        system.head = (system.head + 1) % PARTICLE_CAPACITY;
+        system.used = std::max(system.used, i + 1);
+
+        float angle = p.angle + randomRange(system.rng, -p.spread, p.spread);
+        float speed = randomRange(system.rng, p.speedMin, p.speedMax);
+        system.x[i] = x;
+        system.y[i] = y;
+        system.vx[i] = std::cos(angle) * speed;
+        system.vy[i] = std::sin(angle) * speed;
+        system.age[i] = 0;
+        system.life[i] = randomRange(system.rng, p.lifeMin, p.lifeMax);
+        system.gravity[i] = p.gravity;
+        system.sizeStart[i] = p.sizeStart;
+        system.sizeEnd[i] = p.sizeEnd;
+        system.size[i] = p.sizeStart;
+        system.colorStart[i] = packColor(p.colorStart);
+        system.colorEnd[i] = packColor(p.colorEnd);
+        system.color[i] = system.colorStart[i];
+        system.region[i] = p.region;
+    }
+    return granted;
+}
+
+int emitBurst(ParticleSystem& system, PoolHandle emitter, float x, float y, int count) {
+    Emitter* e = poolGet(system.emitters, emitter);
+    if (!e) return 0;
+    return spawn(system, e->params, x, y, count);
+}
+
+void updateParticles(ParticleSystem& system, float dtMs) {
+    // Continuous emitters draw from the same budget as bursts made since the
+    // last update, then the budget refills for the next tick
+    for (int e = 0; e < poolCount(system.emitters); e++) {
+        Emitter& em = poolAt(system.emitters, e);
+        if (!em.active || em.params.rate <= 0) continue;
+        em.accumulator += em.params.rate * dtMs * 0.001f;
+        int count = static_cast<int>(em.accumulator);
+        em.accumulator -= count;
+        spawn(system, em.params, em.x, em.y, count);
+    }
+
+    float dt = dtMs * 0.001f;
+    int n = system.used;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vdtMs = _mm_set1_ps(dtMs);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(256.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(256);
+    for (; i < n; i += 4) {
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(&system.vy[i]), _mm_mul_ps(_mm_loadu_ps(&system.gravity[i]), vdt));
+        __m128 x = _mm_add_ps(_mm_loadu_ps(&system.x[i]), _mm_mul_ps(_mm_loadu_ps(&system.vx[i]), vdt));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(&system.y[i]), _mm_mul_ps(vy, vdt));
+        __m128 age = _mm_add_ps(_mm_loadu_ps(&system.age[i]), vdtMs);
+        _mm_storeu_ps(&system.vy[i], vy);
+        _mm_storeu_ps(&system.x[i], x);
+        _mm_storeu_ps(&system.y[i], y);
+        _mm_storeu_ps(&system.age[i], age);
+
+        // Normalised age drives size and colour
+        __m128 life = _mm_max_ps(_mm_loadu_ps(&system.life[i]), one);
+        __m128 t = _mm_min_ps(_mm_div_ps(age, life), one);
+        __m128 s0 = _mm_loadu_ps(&system.sizeStart[i]);
+        __m128 s1 = _mm_loadu_ps(&system.sizeEnd[i]);
+        _mm_storeu_ps(&system.size[i], _mm_add_ps(s0, _mm_mul_ps(_mm_sub_ps(s1, s0), t)));
+
+        // Colour lerp in 8.8 fixed point: (c0 * (256 - w) + c1 * w) >> 8 never
+        // exceeds 16 bits. w is rounded half up like the scalar path's, so
+        // both give the same colours. Spread each weight over its 4 channels.
+        __m128i w = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(t, scale), half));
+        __m128i w16 = _mm_packs_epi32(w, w);
+        __m128i wPairs = _mm_unpacklo_epi16(w16, w16);
+        __m128i wLo = _mm_unpacklo_epi32(wPairs, wPairs);
+        __m128i wHi = _mm_unpackhi_epi32(wPairs, wPairs);
+        __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&system.colorStart[i]));
+        __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&system.colorEnd[i]));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c0, zero), _mm_sub_epi16(full, wLo)),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(c1, zero), wLo));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c0, zero), _mm_sub_epi16(full, wHi)),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(c1, zero), wHi));
+        __m128i c = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&system.color[i]), c);
+    }
+#else
+    for (; i < n; i++) {
+        system.vy[i] += system.gravity[i] * dt;
+        system.x[i] += system.vx[i] * dt;
+        system.y[i] += system.vy[i] * dt;
+        system.age[i] += dtMs;
+
+        float t = std::min(system.age[i] / std::max(system.life[i], 1.0f), 1.0f);
+        system.size[i] = system.sizeStart[i] + (system.sizeEnd[i] - system.sizeStart[i]) * t;
+        int w = static_cast<int>(t * 256.0f + 0.5f);
+        const Uint8* c0 = reinterpret_cast<const Uint8*>(&system.colorStart[i]);
+        const Uint8* c1 = reinterpret_cast<const Uint8*>(&system.colorEnd[i]);
+        Uint8* c = reinterpret_cast<Uint8*>(&system.color[i]);
+        for (int k = 0; k < 4; k++) c[k] = static_cast<Uint8>((c0[k] * (256 - w) + c1[k] * w) >> 8);
+    }
+#endif
+
+    system.alive = 0;
+    for (i = 0; i < n; i++) {
+        if (system.age[i] < system.life[i]) system.alive++;
+    }
+    if (system.alive == 0) {
+        // Everything expired: restart the ring so updates stay short
+        system.head = 0;
+        system.used = 0;
+    }
+    system.spawned = system.tickSpawned;
+    system.throttled = system.tickThrottled;
+    system.tickSpawned = 0;
+    system.tickThrottled = 0;
+    system.budget = PARTICLE_BUDGET_PER_FRAME;
+}
+
+void renderParticles(ParticleSystem& system, DrawList& list, const Atlas& atlas, const Camera& camera) {
+    if (system.alive == 0) return;
+    SDL_Vertex* out = beginQuads(list, system.alive);
+    if (!out) return;
+
+    float invW = 1.0f / atlas.width, invH = 1.0f / atlas.height;
+    int quads = 0;
+    for (int i = 0; i < system.used; i++) {
+        if (system.age[i] >= system.life[i]) continue;
+        float half = system.size[i] * 0.5f;
+        if (!cameraVisible(camera, system.x[i] - half, system.y[i] - half,
+                           system.x[i] + half, system.y[i] + half)) continue;
+
+        const SDL_Rect& r = atlas.regions[system.region[i]].rect;
+        float u0 = r.x * invW, v0 = r.y * invH;
+        float u1 = (r.x + r.w) * invW, v1 = (r.y + r.h) * invH;
+        float x0 = cameraScreenX(camera, system.x[i]) - half, y0 = cameraScreenY(camera, system.y[i]) - half;
+        float x1 = x0 + system.size[i], y1 = y0 + system.size[i];
+        SDL_Color c;
+        memcpy(&c, &system.color[i], sizeof(c));
+
+        SDL_Vertex* q = &out[quads * 4];
+        q[0] = {{x0, y0}, c, {u0, v0}};
+        q[1] = {{x1, y0}, c, {u1, v0}};
+        q[2] = {{x1, y1}, c, {u1, v1}};
+        q[3] = {{x0, y1}, c, {u0, v1}};
+        quads++;
+    }
+
+    // Every emitter draws from the shared atlas, so this is the one batch
+    endQuads(list, quads);
+}
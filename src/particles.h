@@ -0,0 +1,70 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "camera.h"
+#include "render.h"
+#include "pool.h"
+#include <vector>
+
+// Ring capacity; a multiple of 4 so SIMD updates never need a scalar tail
+const int PARTICLE_CAPACITY = 16384;
+// Most particles all emitters together may spawn in one tick
+const int PARTICLE_BUDGET_PER_FRAME = 1024;
+// Emitter slots reserved up front; more grow the pool
+const int PARTICLE_MAX_EMITTERS = 32;
+
+//structure
+struct EmitterParams {
+    float rate;               // Particles/s while active; 0 for burst-only
+    float angle, spread;      // Launch direction and half-angle (radians)
+    float speedMin, speedMax; // px/s
+    float gravity;            // px/s^2
+    float lifeMin, lifeMax;   // ms
+    float sizeStart, sizeEnd; // px
+    SDL_Color colorStart, colorEnd;
+    int region;               // Atlas region
+};
+
+struct Emitter {
+    EmitterParams params;
+    float x, y;
+    float accumulator;        // Fractional particles owed by rate
+    bool active;
+};
+
+// Particles are written round-robin into a fixed SoA ring; when it is full
+// the oldest slot is reused, so a flood of effects can never grow memory.
+// Slots [0, used) have been written at least once; dead ones have age >= life.
+struct ParticleSystem {
+    std::vector<float> x, y, vx, vy;
+    std::vector<float> age, life, gravity;
+    std::vector<float> sizeStart, sizeEnd, size;
+    std::vector<Uint32> colorStart, colorEnd, color;  // SDL_Color bytes
+    std::vector<int> region;
+    int head, used;
+    int budget;               // Spawns left this tick
+    int tickSpawned, tickThrottled;
+    Uint32 rng;
+
+    Pool<Emitter> emitters;
+
+    // Stats for the last completed tick
+    int alive, spawned, throttled;
+};
+
+//function definaction
+bool initParticles(ParticleSystem& system);
+void clearParticles(ParticleSystem& system);
+// Emitter calls with a destroyed emitter's handle do nothing
+PoolHandle createEmitter(ParticleSystem& system, const EmitterParams& params);
+// Particles already spawned live out their lives
+void destroyEmitter(ParticleSystem& system, PoolHandle emitter);
+void moveEmitter(ParticleSystem& system, PoolHandle emitter, float x, float y);
+void setEmitterActive(ParticleSystem& system, PoolHandle emitter, bool active);
+// Direction (radians) for the emitter's later particles
+void setEmitterAngle(ParticleSystem& system, PoolHandle emitter, float angle);
+// One-off burst; clipped to what is left of this tick's budget
+int emitBurst(ParticleSystem& system, PoolHandle emitter, float x, float y, int count);
+void updateParticles(ParticleSystem& system, float dtMs);
+// Visible particles as one quad batch from the shared atlas
+void renderParticles(ParticleSystem& system, DrawList& list, const Atlas& atlas, const Camera& camera);
@@ -0,0 +1,139 @@
+#include "perfcounters.h"
+#include "log.h"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int openCounter(Uint32 type, Uint64 config, bool excludeKernel) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;             // Threads created later are counted too
+    attr.exclude_kernel = excludeKernel ? 1 : 0;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// PMU counters count user mode only, which perf_event_paranoid 2 allows.
+// Software events happen in the kernel (context switches always, page faults
+// often), so they are counted there too, unless the system refuses it.
+static int openCounterFor(Uint32 type, Uint64 config) {
+    if (type == PERF_TYPE_HARDWARE) return openCounter(type, config, true);
+    int fd = openCounter(type, config, false);
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+        fd = openCounter(type, config, true);
+        if (fd >= 0 && config == PERF_COUNT_SW_CONTEXT_SWITCHES) {
+            LOG_WARN(LogCategory::PERF, "Kernel counting not allowed; context switches will read 0");
+        }
+    }
+    return fd;
+}
+
+bool initPerfCounters(PerfCounters& counters) {
+    static const Uint32 types[PERF_COUNTER_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE
+    };
+    static const Uint64 configs[PERF_COUNTER_COUNT] = {
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_SW_PAGE_FAULTS,
+        PERF_COUNT_SW_CONTEXT_SWITCHES
+    };
+
+    counters.hardware = true;
+    counters.software = true;
+    int hardwareError = 0;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        counters.fds[i] = openCounterFor(types[i], configs[i]);
+        if (counters.fds[i] >= 0) continue;
+        if (types[i] == PERF_TYPE_HARDWARE) {
+            counters.hardware = false;
+            hardwareError = errno;
+        } else {
+            counters.software = false;
+        }
+    }
+
+    // IPC and miss rates need all of the PMU counters or none
+    if (!counters.hardware) {
+        for (int i = 0; i <= static_cast<int>(PerfCounter::BRANCH_MISSES); i++) {
+            if (counters.fds[i] >= 0) close(counters.fds[i]);
+            counters.fds[i] = -1;
+        }
+        LOG_WARN(LogCategory::PERF, "Hardware counters unavailable ({}){}", strerror(hardwareError),
+                 counters.software ? "; using software counters only" : "");
+    }
+    return counters.hardware || counters.software;
+}
+
+void closePerfCounters(PerfCounters& counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters.fds[i] >= 0) close(counters.fds[i]);
+        counters.fds[i] = -1;
+    }
+    counters.hardware = false;
+    counters.software = false;
+}
+
+void readPerfCounters(const PerfCounters& counters, PerfSample& sample) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        Uint64 data[3] = {0, 0, 0};   // value, time enabled, time running
+        sample.values[i] = 0;
+        if (counters.fds[i] < 0 || read(counters.fds[i], data, sizeof(data)) != sizeof(data)) continue;
+        sample.values[i] = data[2] > 0 && data[2] < data[1]
+                               ? static_cast<Uint64>(static_cast<double>(data[0]) * data[1] / data[2])
+                               : data[0];
+    }
+}
+
+#else
+
+bool initPerfCounters(PerfCounters& counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) counters.fds[i] = -1;
+    counters.hardware = false;
+    counters.software = false;
+    LOG_WARN(LogCategory::PERF, "Performance counters need Linux (perf_event_open)");
+    return false;
+}
+
+void closePerfCounters(PerfCounters& counters) {
+    counters.hardware = false;
+    counters.software = false;
+}
+
+void readPerfCounters(const PerfCounters&, PerfSample& sample) {
+    memset(&sample, 0, sizeof(sample));
+}
+
+#endif
+
+const char* perfCounterName(PerfCounter counter) {
+    switch (counter) {
+    case PerfCounter::INSTRUCTIONS: return "instructions";
+    case PerfCounter::CYCLES: return "cycles";
+    case PerfCounter::CACHE_MISSES: return "cache_misses";
+    case PerfCounter::BRANCH_MISSES: return "branch_misses";
+    case PerfCounter::TASK_CLOCK: return "task_clock";
+    case PerfCounter::PAGE_FAULTS: return "page_faults";
+    case PerfCounter::CONTEXT_SWITCHES: return "context_switches";
+    default: return "?";
+    }
+}
+
+void perfCountersSince(const PerfCounters& counters, PerfSample& mark, Uint64* delta) {
+    if (!counters.hardware && !counters.software) return;
+    PerfSample now;
+    readPerfCounters(counters, now);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        delta[i] = now.values[i] - mark.values[i];
+    }
+    mark = now;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "SDL2/SDL.h"
+
+//enum
+// The first four need a PMU; the rest are kernel software counters, used
+// alongside or instead of them
+enum class PerfCounter {
+    INSTRUCTIONS,
+    CYCLES,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    TASK_CLOCK,               // ns on CPU
+    PAGE_FAULTS,
+    CONTEXT_SWITCHES,
+    COUNT
+};
+
+const int PERF_COUNTER_COUNT = static_cast<int>(PerfCounter::COUNT);
+
+//structure
+// Counters for this process's threads, including ones started after init.
+// fd is -1 where a counter couldn't be opened.
+struct PerfCounters {
+    int fds[PERF_COUNTER_COUNT];
+    bool hardware;            // The PMU counters opened
+    bool software;            // The software counters opened
+};
+
+struct PerfSample {
+    Uint64 values[PERF_COUNTER_COUNT];
+};
+
+//function definaction
+// Linux perf_event_open. Open before starting worker threads so they are
+// counted too. Without PMU access (VMs, perf_event_paranoid) only software
+// counters open; without Linux nothing does. False when nothing opened.
+bool initPerfCounters(PerfCounters& counters);
+void closePerfCounters(PerfCounters& counters);
+const char* perfCounterName(PerfCounter counter);
+// Current totals, scaled up if the kernel had to multiplex
+void readPerfCounters(const PerfCounters& counters, PerfSample& sample);
+// Counts since mark into delta, then move mark to now
+void perfCountersSince(const PerfCounters& counters, PerfSample& mark, Uint64* delta);
+
+// Instructions per cycle, and events per thousand instructions; 0 without
+// the counters
+inline double perfIpc(const Uint64* events) {
+    Uint64 cycles = events[static_cast<int>(PerfCounter::CYCLES)];
+    return cycles ? static_cast<double>(events[static_cast<int>(PerfCounter::INSTRUCTIONS)]) / cycles : 0.0;
+}
+
+inline double perfPerKilo(const Uint64* events, PerfCounter counter) {
+    Uint64 instructions = events[static_cast<int>(PerfCounter::INSTRUCTIONS)];
+    return instructions ? events[static_cast<int>(counter)] * 1000.0 / instructions : 0.0;
+}
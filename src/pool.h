@@ -0,0 +1,150 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Objects per storage chunk; chunks are never moved or freed while the pool
+// lives, so pointers to live objects stay valid as it grows
+const int POOL_CHUNK_SIZE = 64;
+const Uint32 POOL_NOT_LIVE = 0xffffffffu;
+
+//structure
+// Names a pool slot as it was when the handle was made. A slot's generation
+// is odd while it holds an object and goes up by one on create and destroy,
+// so a handle to a destroyed object never matches again and generation 0
+// (the zero-initialised handle) is never valid.
+struct PoolHandle {
+    Uint32 index;
+    Uint32 generation;
+};
+
+inline bool operator==(PoolHandle a, PoolHandle b) {
+    return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator!=(PoolHandle a, PoolHandle b) {
+    return !(a == b);
+}
+
+// Slot pool with generation-checked handles. Create and destroy are O(1)
+// (create is amortised while a new chunk is needed), freed slots are reused
+// before the pool grows, and live contains the live slots packed together
+// for iteration.
+template <typename T>
+struct Pool {
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+    std::vector<std::unique_ptr<Storage[]>> chunks;
+    std::vector<Uint32> generations;  // Per slot
+    std::vector<Uint32> livePosition; // Per slot: index into live, or POOL_NOT_LIVE
+    std::vector<Uint32> live;         // Live slots, in no particular order
+    std::vector<Uint32> freeSlots;    // Stack of slots to reuse
+
+    Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() { clearPool(*this); }
+};
+
+//function definaction
+template <typename T>
+T* poolSlot(Pool<T>& pool, Uint32 index) {
+    return reinterpret_cast<T*>(&pool.chunks[index / POOL_CHUNK_SIZE][index % POOL_CHUNK_SIZE]);
+}
+
+// Make room for capacity objects so creating that many never allocates
+template <typename T>
+void reservePool(Pool<T>& pool, int capacity) {
+    Uint32 slots = static_cast<Uint32>(pool.generations.size());
+    while (pool.chunks.size() * POOL_CHUNK_SIZE < static_cast<std::size_t>(capacity)) {
+        pool.chunks.emplace_back(new typename Pool<T>::Storage[POOL_CHUNK_SIZE]);
+    }
+    Uint32 total = static_cast<Uint32>(pool.chunks.size() * POOL_CHUNK_SIZE);
+    if (total == slots) return;
+    pool.generations.resize(total, 0);
+    pool.livePosition.resize(total, POOL_NOT_LIVE);
+    pool.live.reserve(total);
+    pool.freeSlots.reserve(total);
+    // Pushed highest first, so the lowest slots are handed out first
+    for (Uint32 i = total; i > slots; i--) pool.freeSlots.push_back(i - 1);
+}
+
+// Destroy every live object. Their handles go stale; the storage is kept.
+template <typename T>
+void clearPool(Pool<T>& pool) {
+    for (Uint32 slot : pool.live) {
+        poolSlot(pool, slot)->~T();
+        pool.generations[slot]++;
+        pool.livePosition[slot] = POOL_NOT_LIVE;
+        pool.freeSlots.push_back(slot);
+    }
+    pool.live.clear();
+}
+
+template <typename T>
+PoolHandle poolCreate(Pool<T>& pool, const T& value) {
+    if (pool.freeSlots.empty()) {
+        reservePool(pool, static_cast<int>(pool.generations.size()) + POOL_CHUNK_SIZE);
+    }
+    Uint32 slot = pool.freeSlots.back();
+    pool.freeSlots.pop_back();
+    new (poolSlot(pool, slot)) T(value);
+    pool.generations[slot]++;
+    pool.livePosition[slot] = static_cast<Uint32>(pool.live.size());
+    pool.live.push_back(slot);
+    return {slot, pool.generations[slot]};
+}
+
+// The object handle names, or NULL if it has been destroyed
+template <typename T>
+T* poolGet(Pool<T>& pool, PoolHandle handle) {
+    if (handle.index >= pool.generations.size() || pool.generations[handle.index] != handle.generation ||
+        !(handle.generation & 1)) return NULL;
+    return poolSlot(pool, handle.index);
+}
+
+template <typename T>
+bool poolValid(const Pool<T>& pool, PoolHandle handle) {
+    return handle.index < pool.generations.size() && pool.generations[handle.index] == handle.generation &&
+           (handle.generation & 1);
+}
+
+// False if handle was already stale. The last live object takes the
+// destroyed one's place in live, so iterate backwards to destroy while
+// iterating.
+template <typename T>
+bool poolDestroy(Pool<T>& pool, PoolHandle handle) {
+    if (!poolValid(pool, handle)) return false;
+    Uint32 slot = handle.index;
+    poolSlot(pool, slot)->~T();
+    pool.generations[slot]++;
+
+    Uint32 position = pool.livePosition[slot];
+    Uint32 moved = pool.live.back();
+    pool.live[position] = moved;
+    pool.livePosition[moved] = position;
+    pool.live.pop_back();
+    pool.livePosition[slot] = POOL_NOT_LIVE;
+    pool.freeSlots.push_back(slot);
+    return true;
+}
+
+// Dense iteration: for (int i = 0; i < poolCount(pool); i++) poolAt(pool, i)
+template <typename T>
+int poolCount(const Pool<T>& pool) {
+    return static_cast<int>(pool.live.size());
+}
+
+template <typename T>
+T& poolAt(Pool<T>& pool, int i) {
+    return *poolSlot(pool, pool.live[i]);
+}
+
+template <typename T>
+PoolHandle poolHandleAt(const Pool<T>& pool, int i) {
+    Uint32 slot = pool.live[i];
+    return {slot, pool.generations[slot]};
+}
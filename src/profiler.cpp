@@ -0,0 +1,148 @@
+#include "profiler.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static std::atomic<bool> capturing(false);
+// Each thread claims a slot the first time it names itself or records.
+// Buffers are made for the claimed slots when a capture is armed, so nothing
+// is allocated while one runs, and kept for later captures.
+static std::atomic<ProfileBuffer*> buffers[PROFILE_MAX_THREADS];
+static char slotNames[PROFILE_MAX_THREADS][32];
+static std::atomic<int> slotCount(0);
+// Events from threads that claimed a slot after the capture was armed
+static std::atomic<int> unbuffered(0);
+static thread_local int threadSlot = -1;
+
+// Capture state; only touched by the main thread
+static int framesLeft;
+static int framesCaptured;
+static char capturePath[256];
+static Uint64 captureStart;
+static Uint64 frameStart;
+
+// PROFILE_MAX_THREADS once they are all taken
+static int claimSlot() {
+    int index = slotCount.fetch_add(1);
+    if (index >= PROFILE_MAX_THREADS) {
+        slotCount.store(PROFILE_MAX_THREADS);
+        return PROFILE_MAX_THREADS;
+    }
+    snprintf(slotNames[index], sizeof(slotNames[index]), "thread %d", index);
+    return index;
+}
+
+static void record(const char* name, Uint64 start, Uint64 end) {
+    if (threadSlot < 0) threadSlot = claimSlot();
+    if (threadSlot >= PROFILE_MAX_THREADS) return;
+    ProfileBuffer* buffer = buffers[threadSlot].load(std::memory_order_acquire);
+    if (!buffer) {
+        unbuffered.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    int n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= PROFILE_EVENTS_PER_THREAD) {
+        buffer->dropped++;
+        return;
+    }
+    buffer->events[n] = {name, start, end};
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+ProfileScope::ProfileScope(const char* scopeName) : name(scopeName), start(0) {
+    if (capturing.load(std::memory_order_relaxed)) start = SDL_GetPerformanceCounter();
+}
+
+ProfileScope::~ProfileScope() {
+    // A scope that straddles the end of a capture is left out
+    if (start && capturing.load(std::memory_order_relaxed)) record(name, start, SDL_GetPerformanceCounter());
+}
+
+void profilerThreadName(const char* name) {
+    if (threadSlot < 0) threadSlot = claimSlot();
+    if (threadSlot < PROFILE_MAX_THREADS) snprintf(slotNames[threadSlot], sizeof(slotNames[threadSlot]), "%s", name);
+}
+
+bool profilerCapturing() {
+    return capturing.load(std::memory_order_relaxed);
+}
+
+void profilerStartCapture(int frames, const char* path) {
+    if (capturing.load(std::memory_order_relaxed) || frames <= 0) return;
+    // Every thread seen so far, plus a few spare for threads that start
+    // during the capture
+    int threads = std::min(slotCount.load(std::memory_order_acquire) + PROFILE_SPARE_BUFFERS, PROFILE_MAX_THREADS);
+    for (int i = 0; i < threads; i++) {
+        ProfileBuffer* buffer = buffers[i].load(std::memory_order_relaxed);
+        if (!buffer) buffer = new ProfileBuffer;
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped = 0;
+        buffers[i].store(buffer, std::memory_order_release);
+    }
+    unbuffered.store(0, std::memory_order_relaxed);
+    framesLeft = frames;
+    framesCaptured = 0;
+    snprintf(capturePath, sizeof(capturePath), "%s", path);
+    captureStart = SDL_GetPerformanceCounter();
+    frameStart = captureStart;
+    capturing.store(true, std::memory_order_release);
+}
+
+// Chrome trace-event format: "X" complete events in microseconds since the
+// capture started, one pid, a tid per buffer, named with "M" metadata events
+static void writeCapture() {
+    FILE* file = fopen(capturePath, "w");
+    if (!file) {
+        LOG_ERROR(LogCategory::PERF, "Failed to open trace file {}", capturePath);
+        return;
+    }
+    double toUs = 1e6 / SDL_GetPerformanceFrequency();
+    int events = 0, dropped = 0;
+    const char* separator = "";
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    int threads = std::min(slotCount.load(std::memory_order_acquire), PROFILE_MAX_THREADS);
+    for (int t = 0; t < threads; t++) {
+        const ProfileBuffer* buffer = buffers[t].load(std::memory_order_acquire);
+        if (!buffer) continue;
+        int count = buffer->count.load(std::memory_order_acquire);
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                separator, t, slotNames[t]);
+        separator = ",\n";
+        for (int i = 0; i < count; i++) {
+            const ProfileEvent& e = buffer->events[i];
+            if (e.start < captureStart) continue;
+            events++;
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    e.name, t, (e.start - captureStart) * toUs, (e.end - e.start) * toUs);
+        }
+        dropped += buffer->dropped;
+    }
+    dropped += unbuffered.load(std::memory_order_relaxed);
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    std::cout << "Trace: " << framesCaptured << " frames, " << events << " events on " << threads
+              << " threads written to " << capturePath;
+    if (dropped) std::cout << " (" << dropped << " dropped, buffers full)";
+    std::cout << std::endl;
+}
+
+void profilerEndFrame() {
+    if (!capturing.load(std::memory_order_relaxed)) return;
+    Uint64 now = SDL_GetPerformanceCounter();
+    record("frame", frameStart, now);
+    frameStart = now;
+    framesCaptured++;
+    if (--framesLeft > 0) return;
+
+    capturing.store(false, std::memory_order_relaxed);
+    writeCapture();
+}
+
+void profilerShutdown() {
+    if (!capturing.load(std::memory_order_relaxed)) return;
+    capturing.store(false, std::memory_order_relaxed);
+    writeCapture();
+}
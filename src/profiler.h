@@ -0,0 +1,59 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <atomic>
+
+// Threads that can record in one capture, and events each can hold; later
+// events in a full buffer are dropped and counted
+const int PROFILE_MAX_THREADS = 32;
+const int PROFILE_EVENTS_PER_THREAD = 1 << 15;
+// Buffers made beyond the threads seen so far when a capture is armed
+const int PROFILE_SPARE_BUFFERS = 4;
+// Frames a capture covers unless told otherwise
+const int PROFILE_DEFAULT_FRAMES = 60;
+
+//structure
+// A completed scope: its begin and end on one thread
+struct ProfileEvent {
+    const char* name;         // String literal; never copied
+    Uint64 start, end;        // SDL_GetPerformanceCounter
+};
+
+// One thread's events. Only the owning thread writes; count is published
+// with release so the exporter, running between frames, reads whole events.
+struct ProfileBuffer {
+    ProfileEvent events[PROFILE_EVENTS_PER_THREAD];
+    std::atomic<int> count;
+    int dropped;
+};
+
+// Records the enclosing scope while a capture is running; otherwise costs a
+// relaxed load
+struct ProfileScope {
+    const char* name;
+    Uint64 start;
+    explicit ProfileScope(const char* scopeName);
+    ~ProfileScope();
+};
+
+#ifndef PROFILE_DISABLED
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+//function definaction
+// Name the calling thread in traces
+void profilerThreadName(const char* name);
+bool profilerCapturing();
+// Record every thread for the next frames frames, then write the capture to
+// path as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+// Ignored while a capture is running. Makes the buffers the capture records
+// into, so frames it covers don't allocate.
+void profilerStartCapture(int frames, const char* path);
+// Mark the end of a frame on the main thread, with no jobs in flight. Ends
+// the capture after its last frame and writes it out.
+void profilerEndFrame();
+// Write a capture cut short by exit. Call with no other thread recording.
+void profilerShutdown();
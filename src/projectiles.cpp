@@ -0,0 +1,192 @@
+#include "projectiles.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool initProjectiles(ProjectilePool& pool) {
+    pool.x.assign(PROJECTILE_CAPACITY, 0);
+    pool.y.assign(PROJECTILE_CAPACITY, 0);
+    pool.vx.assign(PROJECTILE_CAPACITY, 0);
+    pool.vy.assign(PROJECTILE_CAPACITY, 0);
+    pool.life.assign(PROJECTILE_CAPACITY, 0);
+    pool.hits.assign(PROJECTILE_CAPACITY, -1);
+    pool.hostile.assign(PROJECTILE_CAPACITY, 0);
+    pool.chunkQuads.assign(PROJECTILE_CAPACITY / PROJECTILE_GRAIN + 1, 0);
+    pool.count = 0;
+    pool.rng = 0x9e3779b9u;
+    pool.region = -1;
+    pool.boundsMinX = 0;
+    pool.boundsMinY = 0;
+    pool.boundsMaxX = 0;
+    pool.boundsMaxY = 0;
+    return true;
+}
+
+void clearProjectiles(ProjectilePool& pool) {
+    pool.count = 0;
+}
+
+bool spawnProjectile(ProjectilePool& pool, float x, float y, float vx, float vy, float lifeMs, bool hostile) {
+    if (pool.count == PROJECTILE_CAPACITY) return false;
+    int i = pool.count++;
+    pool.x[i] = x;
+    pool.y[i] = y;
+    pool.vx[i] = vx;
+    pool.vy[i] = vy;
+    pool.life[i] = lifeMs;
+    pool.hostile[i] = hostile ? 1 : 0;
+    return true;
+}
+
+void spawnProjectileStress(ProjectilePool& pool, int target, float cx, float cy) {
+    target = std::min(target, PROJECTILE_CAPACITY);
+    while (pool.count < target) {
+        float angle = randomRange(pool.rng, 0, 6.2831853f);
+        float speed = PROJECTILE_SPEED * randomRange(pool.rng, 0.25f, 1.0f);
+        float life = PROJECTILE_LIFETIME * randomRange(pool.rng, 0.5f, 1.5f);
+        spawnProjectile(pool, cx, cy, std::cos(angle) * speed, std::sin(angle) * speed, life, true);
+    }
+}
+
+struct ProjectileUpdate {
+    ProjectilePool* pool;
+    const CollisionWorld* world;
+    float dtMs;
+};
+
+// Motion, lifetime and collision for one chunk; chunks touch disjoint ranges
+static void updateChunk(void* data, int begin, int end) {
+    ProjectileUpdate& u = *static_cast<ProjectileUpdate*>(data);
+    ProjectilePool& p = *u.pool;
+    float dt = u.dtMs * 0.001f;
+
+    // begin is a multiple of 4 and the arrays are padded to capacity, so
+    // running whole groups past end only touches dead slots
+    int i = begin;
+#if defined(__SSE2__)
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vdtMs = _mm_set1_ps(u.dtMs);
+    for (; i < end; i += 4) {
+        __m128 x = _mm_add_ps(_mm_loadu_ps(&p.x[i]), _mm_mul_ps(_mm_loadu_ps(&p.vx[i]), vdt));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(&p.y[i]), _mm_mul_ps(_mm_loadu_ps(&p.vy[i]), vdt));
+        __m128 life = _mm_sub_ps(_mm_loadu_ps(&p.life[i]), vdtMs);
+        _mm_storeu_ps(&p.x[i], x);
+        _mm_storeu_ps(&p.y[i], y);
+        _mm_storeu_ps(&p.life[i], life);
+    }
+#else
+    for (; i < end; i++) {
+        p.x[i] += p.vx[i] * dt;
+        p.y[i] += p.vy[i] * dt;
+        p.life[i] -= u.dtMs;
+    }
+#endif
+
+    pointQueryBatch(*u.world, &p.x[begin], &p.y[begin], end - begin, LAYER_WORLD, &p.hits[begin]);
+    for (i = begin; i < end; i++) {
+        if (p.hits[i] >= 0 ||
+            p.x[i] < p.boundsMinX || p.x[i] >= p.boundsMaxX ||
+            p.y[i] < p.boundsMinY || p.y[i] >= p.boundsMaxY) {
+            p.life[i] = 0;
+        }
+    }
+}
+
+static void despawn(ProjectilePool& p, int i) {
+    int last = --p.count;
+    p.x[i] = p.x[last];
+    p.y[i] = p.y[last];
+    p.vx[i] = p.vx[last];
+    p.vy[i] = p.vy[last];
+    p.life[i] = p.life[last];
+    p.hostile[i] = p.hostile[last];
+}
+
+void updateProjectiles(ProjectilePool& pool, const CollisionWorld& world, JobSystem& jobs, float dtMs) {
+    if (pool.count == 0) return;
+    ProjectileUpdate update = {&pool, &world, dtMs};
+    parallelFor(jobs, pool.count, PROJECTILE_GRAIN, updateChunk, &update);
+
+    // Swap-remove expired projectiles, walking down so every projectile
+    // swapped into a hole has already been checked
+    int groups = (pool.count + 3) / 4;
+    for (int g = groups - 1; g >= 0; g--) {
+        int base = g * 4;
+#if defined(__SSE2__)
+        int mask = _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(&pool.life[base]), _mm_setzero_ps()));
+        if (!mask) continue;
+#endif
+        for (int l = 3; l >= 0; l--) {
+            int i = base + l;
+            if (i < pool.count && pool.life[i] <= 0) despawn(pool, i);
+        }
+    }
+}
+
+struct ProjectileVertices {
+    ProjectilePool* pool;
+    SDL_Vertex* out;
+    const Camera* camera;
+    SDL_FPoint uv0, uv1;
+};
+
+// Each job culls its range and writes the survivors at the start of its own
+// slice of the output, so jobs never share vertices
+static void vertexChunk(void* data, int begin, int end) {
+    ProjectileVertices& v = *static_cast<ProjectileVertices*>(data);
+    ProjectilePool& p = *v.pool;
+    const Camera& cam = *v.camera;
+    const float half = PROJECTILE_SIZE * 0.5f;
+    const float viewX0 = cam.x - half, viewY0 = cam.y - half;
+    const float viewX1 = cam.x + cam.viewW + half, viewY1 = cam.y + cam.viewH + half;
+    const SDL_Color white = {255, 255, 255, 255};
+
+    SDL_Vertex* q = v.out + begin * 4;
+    int quads = 0;
+    for (int i = begin; i < end; i++) {
+        if (p.x[i] < viewX0 || p.x[i] >= viewX1 || p.y[i] < viewY0 || p.y[i] >= viewY1) continue;
+        float x0 = cameraScreenX(cam, p.x[i]) - half, y0 = cameraScreenY(cam, p.y[i]) - half;
+        float x1 = x0 + PROJECTILE_SIZE, y1 = y0 + PROJECTILE_SIZE;
+        q[0] = {{x0, y0}, white, {v.uv0.x, v.uv0.y}};
+        q[1] = {{x1, y0}, white, {v.uv1.x, v.uv0.y}};
+        q[2] = {{x1, y1}, white, {v.uv1.x, v.uv1.y}};
+        q[3] = {{x0, y1}, white, {v.uv0.x, v.uv1.y}};
+        q += 4;
+        quads++;
+    }
+    p.chunkQuads[begin / PROJECTILE_GRAIN] = quads;
+}
+
+void renderProjectiles(ProjectilePool& pool, JobSystem& jobs, DrawList& list, const Atlas& atlas,
+                       const Camera& camera) {
+    if (pool.count == 0 || pool.region < 0) return;
+    SDL_Vertex* out = beginQuads(list, pool.count);
+    if (!out) return;
+
+    const SDL_Rect& r = atlas.regions[pool.region].rect;
+    ProjectileVertices build = {
+        &pool, out, &camera,
+        {static_cast<float>(r.x) / atlas.width, static_cast<float>(r.y) / atlas.height},
+        {static_cast<float>(r.x + r.w) / atlas.width, static_cast<float>(r.y + r.h) / atlas.height}
+    };
+    parallelFor(jobs, pool.count, PROJECTILE_GRAIN, vertexChunk, &build);
+
+    // Close the gaps left by culled projectiles
+    int quads = 0;
+    int chunks = (pool.count + PROJECTILE_GRAIN - 1) / PROJECTILE_GRAIN;
+    for (int c = 0; c < chunks; c++) {
+        int n = pool.chunkQuads[c];
+        if (quads != c * PROJECTILE_GRAIN) {
+            memmove(out + quads * 4, out + c * PROJECTILE_GRAIN * 4, n * 4 * sizeof(SDL_Vertex));
+        }
+        quads += n;
+    }
+
+    // Every visible projectile in one batch
+    endQuads(list, quads);
+}
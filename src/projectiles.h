@@ -0,0 +1,49 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "collision.h"
+#include "jobs.h"
+#include "camera.h"
+#include "render.h"
+#include <vector>
+
+// Pool capacity; a multiple of 4 so SIMD updates never need a scalar tail
+const int PROJECTILE_CAPACITY = 131072;
+const float PROJECTILE_SPEED = 480.0f;     // px/s
+const float PROJECTILE_LIFETIME = 1500.0f; // ms
+const int PROJECTILE_SIZE = 6;             // Drawn size in px
+// Projectiles per job when updating or building vertices
+const int PROJECTILE_GRAIN = 4096;
+
+//structure
+// Fixed-capacity SoA pool. Live projectiles are packed into [0, count); the
+// free list is simply the tail [count, capacity), so spawning is an append
+// and despawning swaps the last live projectile into the hole. Every array
+// is sized once at init and nothing is allocated afterwards.
+struct ProjectilePool {
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> life;      // ms left
+    std::vector<int> hits;        // Collider hit this tick, -1 for none
+    std::vector<Uint8> hostile;   // 1 if it hurts the player rather than coming from them
+    int count;
+    Uint32 rng;
+
+    // Kill anything leaving these bounds
+    float boundsMinX, boundsMinY, boundsMaxX, boundsMaxY;
+
+    // Batched rendering from the shared atlas
+    int region;
+    std::vector<int> chunkQuads;  // Visible quads per vertex-build job
+};
+
+//function definaction
+bool initProjectiles(ProjectilePool& pool);
+void clearProjectiles(ProjectilePool& pool);
+bool spawnProjectile(ProjectilePool& pool, float x, float y, float vx, float vy, float lifeMs, bool hostile);
+// Top the pool up to target live hostile projectiles in a radial spray from (cx, cy)
+void spawnProjectileStress(ProjectilePool& pool, int target, float cx, float cy);
+void updateProjectiles(ProjectilePool& pool, const CollisionWorld& world, JobSystem& jobs, float dtMs);
+// Visible projectiles as one quad batch
+void renderProjectiles(ProjectilePool& pool, JobSystem& jobs, DrawList& list, const Atlas& atlas,
+                       const Camera& camera);
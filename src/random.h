@@ -0,0 +1,15 @@
+#pragma once
+#include "SDL2/SDL.h"
+
+// xorshift32: tiny, allocation-free and reproducible from its seed
+inline Uint32 nextRandom(Uint32& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Uniform float in [lo, hi)
+inline float randomRange(Uint32& state, float lo, float hi) {
+    return lo + (hi - lo) * ((nextRandom(state) >> 8) * (1.0f / 16777216.0f));
+}
@@ -0,0 +1,675 @@
+#include "raster.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+// AVX2 kernels are compiled for that target alone and only called when the
+// CPU has it, so the rest of the build keeps its baseline flags. Not on
+// Windows: GCC there doesn't align the stack to 32 bytes (bug 54412) yet
+// spills __m256i with aligned moves, which faults in unoptimised builds.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(_WIN32)
+#include <immintrin.h>
+#define RASTER_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+// x / 255 for x in [0, 255 * 255]
+static inline Uint32 div255(Uint32 x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+void blendRowScalar(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod) {
+    Uint32 mr = (mod >> 16) & 0xff, mg = (mod >> 8) & 0xff, mb = mod & 0xff, ma = mod >> 24;
+    for (int i = 0; i < count; i++, u += du) {
+        Uint32 s = src[u >> RASTER_FRAC_BITS];
+        Uint32 sa = div255((s >> 24) * ma);
+        if (sa == 0) continue;
+        Uint32 sr = div255(div255(((s >> 16) & 0xff) * mr) * sa);
+        Uint32 sg = div255(div255(((s >> 8) & 0xff) * mg) * sa);
+        Uint32 sb = div255(div255((s & 0xff) * mb) * sa);
+
+        Uint32 d = dst[i];
+        Uint32 inv = 255 - sa;
+        Uint32 r = sr + div255(((d >> 16) & 0xff) * inv);
+        Uint32 g = sg + div255(((d >> 8) & 0xff) * inv);
+        Uint32 b = sb + div255((d & 0xff) * inv);
+        Uint32 a = sa + div255((d >> 24) * inv);
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+void blendRowPremultipliedScalar(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod) {
+    Uint32 mr = (mod >> 16) & 0xff, mg = (mod >> 8) & 0xff, mb = mod & 0xff, ma = mod >> 24;
+    for (int i = 0; i < count; i++, u += du) {
+        Uint32 s = src[u >> RASTER_FRAC_BITS];
+        Uint32 sa = div255((s >> 24) * ma);
+        Uint32 sr = div255(div255(((s >> 16) & 0xff) * mr) * ma);
+        Uint32 sg = div255(div255(((s >> 8) & 0xff) * mg) * ma);
+        Uint32 sb = div255(div255((s & 0xff) * mb) * ma);
+
+        Uint32 d = dst[i];
+        Uint32 inv = 255 - sa;
+        Uint32 r = sr + div255(((d >> 16) & 0xff) * inv);
+        Uint32 g = sg + div255(((d >> 8) & 0xff) * inv);
+        Uint32 b = sb + div255((d & 0xff) * inv);
+        Uint32 a = sa + div255((d >> 24) * inv);
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+// The SIMD kernels widen two pixels per 128 bits to 16-bit b, g, r, a lanes
+// and do exactly the scalar arithmetic; every product fits in 16 bits and so
+// does div255's intermediate sum.
+#if defined(__SSE2__)
+static inline __m128i div255Sse2(__m128i x) {
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+// Alpha lane copied to all four lanes of each pixel
+static inline __m128i alphaSse2(__m128i x) {
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xff), 0xff);
+}
+
+// Four texels starting at u; unit steps (1:1 or mirrored 1:1) load directly
+static inline __m128i gatherSse2(const Uint32* src, Sint32 u, Sint32 du) {
+    if (du == 1 << RASTER_FRAC_BITS) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (u >> RASTER_FRAC_BITS)));
+    }
+    if (du == -(1 << RASTER_FRAC_BITS)) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (u >> RASTER_FRAC_BITS) - 3));
+        return _mm_shuffle_epi32(s, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+    return _mm_setr_epi32(static_cast<int>(src[u >> RASTER_FRAC_BITS]),
+                          static_cast<int>(src[(u + du) >> RASTER_FRAC_BITS]),
+                          static_cast<int>(src[(u + 2 * du) >> RASTER_FRAC_BITS]),
+                          static_cast<int>(src[(u + 3 * du) >> RASTER_FRAC_BITS]));
+}
+
+static inline __m128i blendStraightSse2(__m128i s, __m128i d, __m128i mod) {
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i alphaOne = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    __m128i t = div255Sse2(_mm_mullo_epi16(s, mod));
+    __m128i a = alphaSse2(t);
+    // Premultiply colour, leave alpha as is
+    __m128i src = div255Sse2(_mm_mullo_epi16(t, _mm_or_si128(_mm_and_si128(a, colorMask), alphaOne)));
+    return _mm_add_epi16(src, div255Sse2(_mm_mullo_epi16(d, _mm_sub_epi16(full, a))));
+}
+
+static inline __m128i blendPremultipliedSse2(__m128i s, __m128i d, __m128i mod, __m128i modAlpha, bool tinted) {
+    const __m128i full = _mm_set1_epi16(255);
+    if (tinted) s = div255Sse2(_mm_mullo_epi16(div255Sse2(_mm_mullo_epi16(s, mod)), modAlpha));
+    return _mm_add_epi16(s, div255Sse2(_mm_mullo_epi16(d, _mm_sub_epi16(full, alphaSse2(s)))));
+}
+
+static void blendRowSse2(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i m = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(mod)), zero);
+    int i = 0;
+    for (; i + 4 <= count; i += 4, u += 4 * du) {
+        __m128i s = gatherSse2(src, u, du);
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i lo = blendStraightSse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), m);
+        __m128i hi = blendStraightSse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), m);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    blendRowScalar(dst + i, src, count - i, u, du, mod);
+}
+
+static void blendRowPremultipliedSse2(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaOne = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    __m128i m = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(mod)), zero);
+    // Tint alpha for the colour lanes, 255 for the alpha lane
+    __m128i ma = _mm_or_si128(_mm_and_si128(alphaSse2(m), colorMask), alphaOne);
+    bool tinted = mod != 0xffffffffu;
+    int i = 0;
+    for (; i + 4 <= count; i += 4, u += 4 * du) {
+        __m128i s = gatherSse2(src, u, du);
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i lo = blendPremultipliedSse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), m, ma, tinted);
+        __m128i hi = blendPremultipliedSse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), m, ma, tinted);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    blendRowPremultipliedScalar(dst + i, src, count - i, u, du, mod);
+}
+#endif
+
+#if defined(RASTER_AVX2)
+// Same as the SSE2 kernels, eight pixels at a time (four per 128-bit lane)
+AVX2_TARGET static inline __m256i div255Avx2(__m256i x) {
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+AVX2_TARGET static inline __m256i alphaAvx2(__m256i x) {
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0xff), 0xff);
+}
+
+AVX2_TARGET static inline __m256i gatherAvx2(const Uint32* src, Sint32 u, Sint32 du) {
+    if (du == 1 << RASTER_FRAC_BITS) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (u >> RASTER_FRAC_BITS)));
+    }
+    if (du == -(1 << RASTER_FRAC_BITS)) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (u >> RASTER_FRAC_BITS) - 7));
+        return _mm256_permutevar8x32_epi32(s, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+    __m256i steps = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(du));
+    __m256i index = _mm256_srai_epi32(_mm256_add_epi32(_mm256_set1_epi32(u), steps), RASTER_FRAC_BITS);
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(src), index, 4);
+}
+
+AVX2_TARGET static inline __m256i blendStraightAvx2(__m256i s, __m256i d, __m256i mod) {
+    const __m256i full = _mm256_set1_epi16(255);
+    const __m256i alphaOne = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+    const __m256i colorMask = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+    __m256i t = div255Avx2(_mm256_mullo_epi16(s, mod));
+    __m256i a = alphaAvx2(t);
+    __m256i src = div255Avx2(_mm256_mullo_epi16(t, _mm256_or_si256(_mm256_and_si256(a, colorMask), alphaOne)));
+    return _mm256_add_epi16(src, div255Avx2(_mm256_mullo_epi16(d, _mm256_sub_epi16(full, a))));
+}
+
+AVX2_TARGET static inline __m256i blendPremultipliedAvx2(__m256i s, __m256i d, __m256i mod, __m256i modAlpha,
+                                                         bool tinted) {
+    const __m256i full = _mm256_set1_epi16(255);
+    if (tinted) s = div255Avx2(_mm256_mullo_epi16(div255Avx2(_mm256_mullo_epi16(s, mod)), modAlpha));
+    return _mm256_add_epi16(s, div255Avx2(_mm256_mullo_epi16(d, _mm256_sub_epi16(full, alphaAvx2(s)))));
+}
+
+AVX2_TARGET static void blendRowAvx2(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i m = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(mod)), zero);
+    int i = 0;
+    for (; i + 8 <= count; i += 8, u += 8 * du) {
+        __m256i s = gatherAvx2(src, u, du);
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i lo = blendStraightAvx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), m);
+        __m256i hi = blendStraightAvx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), m);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blendRowScalar(dst + i, src, count - i, u, du, mod);
+}
+
+AVX2_TARGET static void blendRowPremultipliedAvx2(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du,
+                                                  Uint32 mod) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaOne = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+    const __m256i colorMask = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+    __m256i m = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(mod)), zero);
+    __m256i ma = _mm256_or_si256(_mm256_and_si256(alphaAvx2(m), colorMask), alphaOne);
+    bool tinted = mod != 0xffffffffu;
+    int i = 0;
+    for (; i + 8 <= count; i += 8, u += 8 * du) {
+        __m256i s = gatherAvx2(src, u, du);
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i lo = blendPremultipliedAvx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero),
+                                            m, ma, tinted);
+        __m256i hi = blendPremultipliedAvx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero),
+                                            m, ma, tinted);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blendRowPremultipliedScalar(dst + i, src, count - i, u, du, mod);
+}
+#endif
+
+RowKernel rowKernel(RasterIsa isa, bool premultiplied) {
+    switch (isa) {
+    case RasterIsa::SCALAR:
+        return premultiplied ? blendRowPremultipliedScalar : blendRowScalar;
+#if defined(__SSE2__)
+    case RasterIsa::SSE2:
+        return SDL_HasSSE2() ? (premultiplied ? blendRowPremultipliedSse2 : blendRowSse2) : NULL;
+#endif
+#if defined(RASTER_AVX2)
+    case RasterIsa::AVX2:
+        return SDL_HasAVX2() ? (premultiplied ? blendRowPremultipliedAvx2 : blendRowAvx2) : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+const char* rasterIsaName(RasterIsa isa) {
+    switch (isa) {
+    case RasterIsa::SCALAR: return "scalar";
+    case RasterIsa::SSE2: return "sse2";
+    case RasterIsa::AVX2: return "avx2";
+    default: return "?";
+    }
+}
+
+RasterIsa bestRasterIsa() {
+    if (rowKernel(RasterIsa::AVX2, false)) return RasterIsa::AVX2;
+    if (rowKernel(RasterIsa::SSE2, false)) return RasterIsa::SSE2;
+    return RasterIsa::SCALAR;
+}
+
+static RasterIsa activeIsa = bestRasterIsa();
+
+bool setRasterIsa(RasterIsa isa) {
+    if (!rowKernel(isa, false)) return false;
+    activeIsa = isa;
+    return true;
+}
+
+RasterIsa rasterIsa() {
+    return activeIsa;
+}
+
+bool initRasterSource(RasterSource& source, const Atlas& atlas, bool premultiply) {
+    source.pixels = atlas.surface;
+    source.width = atlas.width;
+    source.height = atlas.height;
+    source.premultiplied = false;
+    source.ownsPixels = false;
+    if (!premultiply) return true;
+
+    SDL_Surface* copy = SDL_CreateRGBSurfaceWithFormat(0, atlas.surface->w, atlas.surface->h, 32,
+                                                       SDL_PIXELFORMAT_ARGB8888);
+    if (!copy) {
+        LOG_ERROR(LogCategory::RENDER, "Failed to create premultiplied atlas: {}", SDL_GetError());
+        return false;
+    }
+    for (int y = 0; y < atlas.height; y++) {
+        const Uint32* in = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(atlas.surface->pixels) +
+                                                           y * atlas.surface->pitch);
+        Uint32* out = reinterpret_cast<Uint32*>(static_cast<Uint8*>(copy->pixels) + y * copy->pitch);
+        for (int x = 0; x < atlas.width; x++) {
+            Uint32 a = in[x] >> 24;
+            out[x] = (a << 24) | (div255(((in[x] >> 16) & 0xff) * a) << 16) |
+                     (div255(((in[x] >> 8) & 0xff) * a) << 8) | div255((in[x] & 0xff) * a);
+        }
+    }
+    source.pixels = copy;
+    source.premultiplied = true;
+    source.ownsPixels = true;
+    return true;
+}
+
+void destroyRasterSource(RasterSource& source) {
+    if (source.ownsPixels) SDL_FreeSurface(source.pixels);
+    source.pixels = NULL;
+    source.ownsPixels = false;
+}
+
+static inline Uint32* pixelRow(SDL_Surface* s, int y) {
+    return reinterpret_cast<Uint32*>(static_cast<Uint8*>(s->pixels) + y * s->pitch);
+}
+
+// First pixel whose centre lies at or past edge
+static inline int pixelEdge(float edge) {
+    return static_cast<int>(std::ceil(edge - 0.5f));
+}
+
+// Source position of the first pixel centre and the per-pixel step for
+// mapping srcSize texels across [d0, d1), in 16.16. Both round down, so the
+// last pixel inside the span never reads past the source.
+static void sourceStep(int first, float d0, float d1, int srcSize, bool flip, Sint32& u, Sint32& du) {
+    double step = std::min(srcSize * 65536.0 / (d1 - d0), srcSize * 65536.0);
+    du = static_cast<Sint32>(step);
+    u = static_cast<Sint32>((first + 0.5 - d0) * du);
+    if (flip) {
+        u = (srcSize << RASTER_FRAC_BITS) - 1 - u;
+        du = -du;
+    }
+}
+
+// A draw command, or one quad of a batch, in target pixels
+static RasterPrim spritePrim(const SDL_Rect& src, float x0, float y0, float x1, float y1,
+                             bool flipH, bool flipV, Uint32 mod) {
+    RasterPrim prim = {x0, y0, x1, y1, src, mod, 0};
+    if (flipH) prim.flags |= RASTER_FLIP_H;
+    if (flipV) prim.flags |= RASTER_FLIP_V;
+    return prim;
+}
+
+static RasterPrim linePrim(float x0, float y0, float x1, float y1, SDL_Color color) {
+    Uint32 argb = (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+    return {x0, y0, x1, y1, {0, 0, 0, 0}, argb, RASTER_LINE};
+}
+
+// Calls emit(prim) for every primitive of the list, in draw order
+template <typename Emit>
+static void forEachPrim(const RasterSource& source, const DrawList& list, float scaleX, float scaleY, Emit emit) {
+    for (const DrawCommand& cmd : list.commands) {
+        switch (cmd.type) {
+        case DrawType::SPRITE:
+            emit(spritePrim(cmd.src, cmd.dst.x * scaleX, cmd.dst.y * scaleY,
+                            (cmd.dst.x + cmd.dst.w) * scaleX, (cmd.dst.y + cmd.dst.h) * scaleY,
+                            (cmd.flip & SDL_FLIP_HORIZONTAL) != 0, (cmd.flip & SDL_FLIP_VERTICAL) != 0,
+                            0xffffffffu));
+            break;
+        case DrawType::QUADS:
+            for (int q = 0; q < cmd.quadCount; q++) {
+                const SDL_Vertex* v = &list.vertices[cmd.firstVertex + q * 4];
+                int sx0 = static_cast<int>(std::lround(v[0].tex_coord.x * source.width));
+                int sy0 = static_cast<int>(std::lround(v[0].tex_coord.y * source.height));
+                int sx1 = static_cast<int>(std::lround(v[2].tex_coord.x * source.width));
+                int sy1 = static_cast<int>(std::lround(v[2].tex_coord.y * source.height));
+                SDL_Rect src = {std::min(sx0, sx1), std::min(sy0, sy1), std::abs(sx1 - sx0), std::abs(sy1 - sy0)};
+                const SDL_Color& c = v[0].color;
+                emit(spritePrim(src, v[0].position.x * scaleX, v[0].position.y * scaleY,
+                                v[2].position.x * scaleX, v[2].position.y * scaleY,
+                                sx1 < sx0, sy1 < sy0, (c.a << 24) | (c.r << 16) | (c.g << 8) | c.b));
+            }
+            break;
+        case DrawType::LINE:
+            emit(linePrim(cmd.dst.x * scaleX, cmd.dst.y * scaleY,
+                          (cmd.dst.x + cmd.dst.w) * scaleX, (cmd.dst.y + cmd.dst.h) * scaleY, cmd.color));
+            break;
+        }
+    }
+}
+
+// Pixels a primitive may touch, for binning
+static SDL_Rect primBounds(const RasterPrim& prim) {
+    if (prim.flags & RASTER_LINE) {
+        int x0 = static_cast<int>(std::floor(std::min(prim.x0, prim.x1)));
+        int y0 = static_cast<int>(std::floor(std::min(prim.y0, prim.y1)));
+        int x1 = static_cast<int>(std::floor(std::max(prim.x0, prim.x1)));
+        int y1 = static_cast<int>(std::floor(std::max(prim.y0, prim.y1)));
+        return {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+    }
+    if (prim.src.w <= 0 || prim.src.h <= 0 || prim.x1 <= prim.x0 || prim.y1 <= prim.y0) return {0, 0, 0, 0};
+    int x0 = pixelEdge(prim.x0), y0 = pixelEdge(prim.y0);
+    return {x0, y0, pixelEdge(prim.x1) - x0, pixelEdge(prim.y1) - y0};
+}
+
+// Scaled, optionally flipped and tinted copy of an atlas rect, clipped.
+// Source steps start from the unclipped edge, so every pixel samples the
+// same texel whatever the clip: tiles drawn separately match one full draw.
+static void drawSpritePrim(SDL_Surface* target, const SDL_Rect& clip, RowKernel blend, const SDL_Surface* atlas,
+                       const RasterPrim& prim) {
+    const SDL_Rect& src = prim.src;
+    if (src.w <= 0 || src.h <= 0 || prim.x1 <= prim.x0 || prim.y1 <= prim.y0) return;
+    int ex0 = pixelEdge(prim.x0), ey0 = pixelEdge(prim.y0);
+    int ix0 = std::max(ex0, clip.x);
+    int ix1 = std::min(pixelEdge(prim.x1), clip.x + clip.w);
+    int iy0 = std::max(ey0, clip.y);
+    int iy1 = std::min(pixelEdge(prim.y1), clip.y + clip.h);
+    if (ix0 >= ix1 || iy0 >= iy1) return;
+
+    Sint32 u, du, v, dv;
+    sourceStep(ex0, prim.x0, prim.x1, src.w, (prim.flags & RASTER_FLIP_H) != 0, u, du);
+    sourceStep(ey0, prim.y0, prim.y1, src.h, (prim.flags & RASTER_FLIP_V) != 0, v, dv);
+    u += (ix0 - ex0) * du;
+    v += (iy0 - ey0) * dv;
+
+    const Uint8* base = static_cast<const Uint8*>(atlas->pixels);
+    for (int y = iy0; y < iy1; y++, v += dv) {
+        const Uint32* row = reinterpret_cast<const Uint32*>(base + (src.y + (v >> RASTER_FRAC_BITS)) * atlas->pitch) + src.x;
+        blend(pixelRow(target, y) + ix0, row, ix1 - ix0, u, du, prim.color);
+    }
+}
+
+// Lines take a straight-alpha kernel whatever the atlas is
+static void drawLinePrim(SDL_Surface* target, const SDL_Rect& clip, RowKernel blend, const RasterPrim& prim) {
+    const Uint32* argb = &prim.color;
+    int px0 = static_cast<int>(std::floor(prim.x0)), py0 = static_cast<int>(std::floor(prim.y0));
+    int px1 = static_cast<int>(std::floor(prim.x1)), py1 = static_cast<int>(std::floor(prim.y1));
+
+    // Horizontal runs (the ground) go through the span kernel in one call
+    if (py0 == py1) {
+        if (py0 < clip.y || py0 >= clip.y + clip.h) return;
+        int a = std::max(std::min(px0, px1), clip.x);
+        int b = std::min(std::max(px0, px1) + 1, clip.x + clip.w);
+        if (a < b) blend(pixelRow(target, py0) + a, argb, b - a, 0, 0, 0xffffffffu);
+        return;
+    }
+
+    int steps = std::max(std::abs(px1 - px0), std::abs(py1 - py0));
+    for (int i = 0; i <= steps; i++) {
+        int x = px0 + static_cast<int>(std::lround(static_cast<double>(px1 - px0) * i / steps));
+        int y = py0 + static_cast<int>(std::lround(static_cast<double>(py1 - py0) * i / steps));
+        if (x < clip.x || x >= clip.x + clip.w || y < clip.y || y >= clip.y + clip.h) continue;
+        blend(pixelRow(target, y) + x, argb, 1, 0, 0, 0xffffffffu);
+    }
+}
+
+static inline void drawPrim(SDL_Surface* target, const SDL_Rect& clip, RowKernel blend, RowKernel lineBlend,
+                            const SDL_Surface* atlas, const RasterPrim& prim) {
+    if (prim.flags & RASTER_LINE) {
+        drawLinePrim(target, clip, lineBlend, prim);
+    } else {
+        drawSpritePrim(target, clip, blend, atlas, prim);
+    }
+}
+
+static void fillRect(SDL_Surface* target, const SDL_Rect& rect, Uint32 color) {
+    for (int y = rect.y; y < rect.y + rect.h; y++) {
+        std::fill_n(pixelRow(target, y) + rect.x, rect.w, color);
+    }
+}
+
+void rasterDrawList(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source, const DrawList& list,
+                    float scaleX, float scaleY) {
+    RowKernel blend = rowKernel(activeIsa, source.premultiplied);
+    RowKernel lineBlend = rowKernel(activeIsa, false);
+    const SDL_Color& clear = list.clearColor;
+
+    if (SDL_MUSTLOCK(target)) SDL_LockSurface(target);
+    fillRect(target, clip, SDL_MapRGBA(target->format, clear.r, clear.g, clear.b, clear.a));
+    forEachPrim(source, list, scaleX, scaleY, [&](const RasterPrim& prim) {
+        drawPrim(target, clip, blend, lineBlend, source.pixels, prim);
+    });
+    if (SDL_MUSTLOCK(target)) SDL_UnlockSurface(target);
+}
+
+void initRasterBins(RasterBins& bins) {
+    bins.prims.reserve(DRAW_MAX_QUADS + DRAW_MAX_COMMANDS);
+    bins.primHash.reserve(DRAW_MAX_QUADS + DRAW_MAX_COMMANDS);
+    bins.tileStart.clear();
+    bins.tileItems.clear();
+    bins.tilesX = 0;
+    bins.tilesY = 0;
+    bins.clip = {0, 0, 0, 0};
+    bins.hashesValid = false;
+}
+
+void invalidateRasterBins(RasterBins& bins) {
+    bins.hashesValid = false;
+}
+
+void damageRasterRect(RasterBins& bins, const SDL_Rect& rect) {
+    if (!bins.hashesValid) return;
+    const SDL_Rect& clip = bins.clip;
+    int tx0 = std::max(0, (rect.x - clip.x) / RASTER_TILE_SIZE);
+    int ty0 = std::max(0, (rect.y - clip.y) / RASTER_TILE_SIZE);
+    int tx1 = std::min(bins.tilesX - 1, (rect.x + rect.w - 1 - clip.x) / RASTER_TILE_SIZE);
+    int ty1 = std::min(bins.tilesY - 1, (rect.y + rect.h - 1 - clip.y) / RASTER_TILE_SIZE);
+    if (rect.w <= 0 || rect.h <= 0 || rect.x + rect.w <= clip.x || rect.y + rect.h <= clip.y) return;
+    // An unchanged tile hashes to its old value, which no longer matches
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) bins.tileHash[ty * bins.tilesX + tx] ^= 1;
+    }
+}
+
+// Flatten to primitives, then counting-sort their ids into every tile they
+// overlap. Ids go in ascending, so each tile keeps draw order. Returns the
+// tile count.
+static int binPrims(RasterBins& bins, const SDL_Rect& clip, const RasterSource& source, const DrawList& list,
+                    float scaleX, float scaleY) {
+    if (clip.x != bins.clip.x || clip.y != bins.clip.y || clip.w != bins.clip.w || clip.h != bins.clip.h) {
+        bins.hashesValid = false;
+    }
+    bins.clip = clip;
+    bins.tilesX = (clip.w + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    bins.tilesY = (clip.h + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles = bins.tilesX * bins.tilesY;
+    if (tiles == 0) return 0;
+
+    bins.prims.clear();
+    forEachPrim(source, list, scaleX, scaleY, [&](const RasterPrim& prim) { bins.prims.push_back(prim); });
+
+    int count = static_cast<int>(bins.prims.size());
+    bins.tileStart.assign(tiles + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < count; i++) {
+            SDL_Rect b = primBounds(bins.prims[i]);
+            int tx0 = std::max(0, (b.x - clip.x) / RASTER_TILE_SIZE);
+            int ty0 = std::max(0, (b.y - clip.y) / RASTER_TILE_SIZE);
+            int tx1 = std::min(bins.tilesX - 1, (b.x + b.w - 1 - clip.x) / RASTER_TILE_SIZE);
+            int ty1 = std::min(bins.tilesY - 1, (b.y + b.h - 1 - clip.y) / RASTER_TILE_SIZE);
+            if (b.w <= 0 || b.h <= 0 || b.x + b.w <= clip.x || b.y + b.h <= clip.y) continue;
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) {
+                    int tile = ty * bins.tilesX + tx;
+                    if (pass == 0) {
+                        bins.tileStart[tile + 1]++;
+                    } else {
+                        bins.tileItems[bins.tileStart[tile]++] = i;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int t = 0; t < tiles; t++) bins.tileStart[t + 1] += bins.tileStart[t];
+            if (static_cast<int>(bins.tileItems.size()) < bins.tileStart[tiles]) {
+                bins.tileItems.resize(bins.tileStart[tiles]);
+            }
+        } else {
+            // The fill pass advanced every start to the next tile's; shift back
+            for (int t = tiles; t > 0; t--) bins.tileStart[t] = bins.tileStart[t - 1];
+            bins.tileStart[0] = 0;
+        }
+    }
+    return tiles;
+}
+
+// Everything a tile job needs
+struct TileRaster {
+    SDL_Surface* target;
+    const RasterSource* source;
+    const RasterBins* bins;
+    const int* tiles;         // Tile ids to draw, or NULL for [begin, end) as is
+    RowKernel blend, lineBlend;
+    Uint32 clearColor;
+};
+
+static void rasterTiles(void* data, int begin, int end) {
+    const TileRaster& t = *static_cast<const TileRaster*>(data);
+    const RasterBins& bins = *t.bins;
+    for (int job = begin; job < end; job++) {
+        int tile = t.tiles ? t.tiles[job] : job;
+        int tx = tile % bins.tilesX, ty = tile / bins.tilesX;
+        SDL_Rect rect = {bins.clip.x + tx * RASTER_TILE_SIZE, bins.clip.y + ty * RASTER_TILE_SIZE,
+                         RASTER_TILE_SIZE, RASTER_TILE_SIZE};
+        rect.w = std::min(rect.w, bins.clip.x + bins.clip.w - rect.x);
+        rect.h = std::min(rect.h, bins.clip.y + bins.clip.h - rect.y);
+
+        fillRect(t.target, rect, t.clearColor);
+        for (int i = bins.tileStart[tile]; i < bins.tileStart[tile + 1]; i++) {
+            drawPrim(t.target, rect, t.blend, t.lineBlend, t.source->pixels, bins.prims[bins.tileItems[i]]);
+        }
+    }
+}
+
+// Draw count tiles (ids from tiles, or all of them), in parallel if jobs
+static void drawTiles(SDL_Surface* target, const RasterSource& source, const DrawList& list,
+                      const RasterBins& bins, const int* tiles, int count, JobSystem* jobs) {
+    const SDL_Color& clear = list.clearColor;
+    TileRaster work = {
+        target, &source, &bins, tiles,
+        rowKernel(activeIsa, source.premultiplied), rowKernel(activeIsa, false),
+        SDL_MapRGBA(target->format, clear.r, clear.g, clear.b, clear.a)
+    };
+    if (SDL_MUSTLOCK(target)) SDL_LockSurface(target);
+    if (jobs) {
+        parallelFor(*jobs, count, 1, rasterTiles, &work);
+    } else {
+        rasterTiles(&work, 0, count);
+    }
+    if (SDL_MUSTLOCK(target)) SDL_UnlockSurface(target);
+}
+
+void rasterDrawListTiled(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source,
+                         const DrawList& list, float scaleX, float scaleY, RasterBins& bins, JobSystem& jobs) {
+    int tiles = binPrims(bins, clip, source, list, scaleX, scaleY);
+    drawTiles(target, source, list, bins, NULL, tiles, &jobs);
+    // Tile hashes weren't kept up to date
+    bins.hashesValid = false;
+}
+
+static inline Uint64 mixHash(Uint64 h, Uint64 value) {
+    return (h ^ value) * 0x100000001b3ull;
+}
+
+static Uint64 primHash(const RasterPrim& prim) {
+    Uint32 bits[4];
+    memcpy(bits, &prim.x0, sizeof(bits[0]));
+    memcpy(bits + 1, &prim.y0, sizeof(bits[1]));
+    memcpy(bits + 2, &prim.x1, sizeof(bits[2]));
+    memcpy(bits + 3, &prim.y1, sizeof(bits[3]));
+    Uint64 h = 0xcbf29ce484222325ull;
+    h = mixHash(h, (static_cast<Uint64>(bits[0]) << 32) | bits[1]);
+    h = mixHash(h, (static_cast<Uint64>(bits[2]) << 32) | bits[3]);
+    h = mixHash(h, (static_cast<Uint64>(static_cast<Uint32>(prim.src.x)) << 32) | static_cast<Uint32>(prim.src.y));
+    h = mixHash(h, (static_cast<Uint64>(static_cast<Uint32>(prim.src.w)) << 32) | static_cast<Uint32>(prim.src.h));
+    h = mixHash(h, (static_cast<Uint64>(prim.color) << 8) | prim.flags);
+    return h;
+}
+
+bool rasterDrawListDirty(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source,
+                         const DrawList& list, float scaleX, float scaleY, RasterBins& bins, JobSystem* jobs,
+                         std::vector<SDL_Rect>& damage) {
+    damage.clear();
+    int tiles = binPrims(bins, clip, source, list, scaleX, scaleY);
+
+    // A tile's pixels depend only on the clear colour and its primitives in
+    // order, so equal hashes mean it would redraw the same
+    int count = static_cast<int>(bins.prims.size());
+    bins.primHash.resize(count);
+    for (int i = 0; i < count; i++) bins.primHash[i] = primHash(bins.prims[i]);
+
+    if (!bins.hashesValid || static_cast<int>(bins.tileHash.size()) != tiles) {
+        bins.tileHash.assign(tiles, 0);
+    }
+    const SDL_Color& clear = list.clearColor;
+    Uint64 seed = mixHash(0xcbf29ce484222325ull, (clear.r << 24) | (clear.g << 16) | (clear.b << 8) | clear.a);
+    bins.dirtyTiles.clear();
+    for (int t = 0; t < tiles; t++) {
+        Uint64 h = seed;
+        for (int i = bins.tileStart[t]; i < bins.tileStart[t + 1]; i++) h = mixHash(h, bins.primHash[bins.tileItems[i]]);
+        if (!bins.hashesValid || h != bins.tileHash[t]) bins.dirtyTiles.push_back(t);
+        bins.tileHash[t] = h;
+    }
+    bool full = !bins.hashesValid || bins.dirtyTiles.size() > tiles * RASTER_DIRTY_FULL_FRACTION;
+    bins.hashesValid = true;
+
+    if (full) {
+        drawTiles(target, source, list, bins, NULL, tiles, jobs);
+        damage.push_back(clip);
+        return false;
+    }
+    if (bins.dirtyTiles.empty()) return true;
+    drawTiles(target, source, list, bins, bins.dirtyTiles.data(), static_cast<int>(bins.dirtyTiles.size()), jobs);
+
+    // Runs of dirty tiles along each tile row become one rect
+    for (size_t i = 0; i < bins.dirtyTiles.size(); ) {
+        int first = bins.dirtyTiles[i];
+        int last = first;
+        while (++i < bins.dirtyTiles.size() && bins.dirtyTiles[i] == last + 1 && (last + 1) % bins.tilesX != 0) {
+            last++;
+        }
+        int tx = first % bins.tilesX, ty = first / bins.tilesX;
+        SDL_Rect rect = {clip.x + tx * RASTER_TILE_SIZE, clip.y + ty * RASTER_TILE_SIZE,
+                         (last - first + 1) * RASTER_TILE_SIZE, RASTER_TILE_SIZE};
+        rect.w = std::min(rect.w, clip.x + clip.w - rect.x);
+        rect.h = std::min(rect.h, clip.y + clip.h - rect.y);
+        damage.push_back(rect);
+    }
+    return true;
+}
+
+void rasterComposite(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source, const SDL_FRect& dst) {
+    SDL_Rect src = {0, 0, source.width, source.height};
+    RasterPrim prim = spritePrim(src, dst.x, dst.y, dst.x + dst.w, dst.y + dst.h, false, false, 0xffffffffu);
+    if (SDL_MUSTLOCK(target)) SDL_LockSurface(target);
+    drawSpritePrim(target, clip, rowKernel(activeIsa, source.premultiplied), source.pixels, prim);
+    if (SDL_MUSTLOCK(target)) SDL_UnlockSurface(target);
+}
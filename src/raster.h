@@ -0,0 +1,122 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "render.h"
+#include "jobs.h"
+#include <vector>
+
+// Source coordinates while stepping along a destination row or column are
+// 16.16 fixed point; a negative step walks the source backwards (flipped)
+const int RASTER_FRAC_BITS = 16;
+// Side of the square screen tiles the parallel rasteriser hands to workers
+const int RASTER_TILE_SIZE = 64;
+// Dirty-rect drawing redraws everything once more than this share of the
+// tiles changed; past that the per-rect present costs more than it saves
+const float RASTER_DIRTY_FULL_FRACTION = 0.5f;
+
+// RasterPrim flags
+const Uint8 RASTER_FLIP_H = 1 << 0;
+const Uint8 RASTER_FLIP_V = 1 << 1;
+const Uint8 RASTER_LINE = 1 << 2;
+
+//enum
+// Instruction set the row kernels run with
+enum class RasterIsa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    COUNT
+};
+
+//structure
+// Texels the rasteriser samples: the atlas pixels, or a premultiplied copy
+struct RasterSource {
+    SDL_Surface* pixels;      // ARGB8888, atlas layout
+    int width, height;        // Atlas used size, for turning UVs into texels
+    bool premultiplied;
+    bool ownsPixels;
+};
+
+// A sprite, one quad of a batch or a line, in target pixels
+struct RasterPrim {
+    float x0, y0, x1, y1;     // Destination rect, or line end points
+    SDL_Rect src;             // Atlas texels; unused for lines
+    Uint32 color;             // Tint, or line colour (0xAARRGGBB)
+    Uint8 flags;
+};
+
+// Per-frame scratch for tiled rasterisation, kept between frames so it
+// only grows. Primitive ids are counting-sorted into every tile they
+// overlap, in draw order.
+struct RasterBins {
+    std::vector<RasterPrim> prims;
+    std::vector<int> tileStart;   // tilesX * tilesY + 1 offsets into tileItems
+    std::vector<int> tileItems;
+    int tilesX, tilesY;
+    SDL_Rect clip;
+
+    // Dirty-rect state: a hash of what each tile drew last frame
+    std::vector<Uint64> primHash;
+    std::vector<Uint64> tileHash;
+    std::vector<int> dirtyTiles;
+    bool hashesValid;
+};
+
+// One row: nearest-neighbour sample count src texels starting at u (16.16),
+// stepping du per pixel, tint by mod (0xAARRGGBB, 0xffffffff = untinted) and
+// blend source-over onto dst
+typedef void (*RowKernel)(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod);
+
+//function definaction
+// Scalar references. Straight alpha uses the SDL_BLENDMODE_BLEND formula of
+// SDL's software blitters (modulate, premultiply, then
+// dst = src + dst * (255 - srcA) / 255, truncating). The premultiplied form
+// scales the texel by the tint's colour and alpha and skips the premultiply;
+// untinted, both give identical pixels. Every SIMD variant must match these
+// bit for bit.
+void blendRowScalar(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod);
+void blendRowPremultipliedScalar(Uint32* dst, const Uint32* src, int count, Sint32 u, Sint32 du, Uint32 mod);
+
+// Kernels for an instruction set; NULL when the build or CPU lacks it
+RowKernel rowKernel(RasterIsa isa, bool premultiplied);
+const char* rasterIsaName(RasterIsa isa);
+// Widest instruction set this CPU runs, picked at startup
+RasterIsa bestRasterIsa();
+// Force the kernels rasterDrawList uses (benchmarks); false if unsupported
+bool setRasterIsa(RasterIsa isa);
+RasterIsa rasterIsa();
+
+// Sample straight from the atlas, or from a premultiplied copy of it
+bool initRasterSource(RasterSource& source, const Atlas& atlas, bool premultiply);
+void destroyRasterSource(RasterSource& source);
+
+// Execute a draw list on the CPU into a 32-bit ARGB8888 or XRGB8888 surface.
+// Logical coordinates are multiplied by scaleX/scaleY and drawing is clipped
+// to clip. Quads are treated as axis-aligned rectangles (vertex 0 top-left,
+// vertex 2 bottom-right, one colour), which is all the game emits.
+void rasterDrawList(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source, const DrawList& list,
+                    float scaleX, float scaleY);
+void initRasterBins(RasterBins& bins);
+// Forget what the target holds, so the next dirty-rect draw is a full one
+void invalidateRasterBins(RasterBins& bins);
+// Something else drew over rect of the target: redraw its tiles next time
+void damageRasterRect(RasterBins& bins, const SDL_Rect& rect);
+// Same output as rasterDrawList, bit for bit: the clip is cut into
+// RASTER_TILE_SIZE tiles, primitives are binned per tile, and tiles are
+// cleared and drawn in parallel. Each pixel still sees its primitives in
+// draw order with the same texel steps.
+void rasterDrawListTiled(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source,
+                         const DrawList& list, float scaleX, float scaleY, RasterBins& bins, JobSystem& jobs);
+// Like rasterDrawListTiled, but into a target that still holds the last
+// frame drawn with these bins: only tiles whose primitives changed (moved,
+// restyled, animated, added or removed) are redrawn. damage receives the
+// redrawn area as rects. Returns false after a full redraw (first frame,
+// after invalidateRasterBins, or past RASTER_DIRTY_FULL_FRACTION). jobs may
+// be NULL to draw on this thread.
+bool rasterDrawListDirty(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source,
+                         const DrawList& list, float scaleX, float scaleY, RasterBins& bins, JobSystem* jobs,
+                         std::vector<SDL_Rect>& damage);
+// Blend all of a premultiplied or straight source over target, stretched to
+// dst (target pixels) and clipped to clip. Used to lay cached layers over a
+// finished frame.
+void rasterComposite(SDL_Surface* target, const SDL_Rect& clip, const RasterSource& source, const SDL_FRect& dst);
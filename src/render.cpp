@@ -0,0 +1,79 @@
+#include "render.h"
+
+#include <algorithm>
+
+void initDrawList(DrawList& list) {
+    list.commands.reserve(DRAW_MAX_COMMANDS);
+    list.vertices.resize(DRAW_MAX_QUADS * 4);
+    list.quadIndices.resize(DRAW_MAX_QUADS * 6);
+    for (int i = 0; i < DRAW_MAX_QUADS; i++) {
+        int* idx = &list.quadIndices[i * 6];
+        int v = i * 4;
+        idx[0] = v;
+        idx[1] = v + 1;
+        idx[2] = v + 2;
+        idx[3] = v + 2;
+        idx[4] = v + 3;
+        idx[5] = v;
+    }
+    clearDrawList(list, {0, 0, 0, 255});
+}
+
+void clearDrawList(DrawList& list, SDL_Color clearColor) {
+    list.commands.clear();
+    list.vertexCount = 0;
+    list.clearColor = clearColor;
+}
+
+void drawSprite(DrawList& list, const SDL_Rect& src, const SDL_FRect& dst, SDL_RendererFlip flip) {
+    if (list.commands.size() == DRAW_MAX_COMMANDS) return;
+    DrawCommand cmd = {DrawType::SPRITE, src, dst, flip, {255, 255, 255, 255}, 0, 0};
+    list.commands.push_back(cmd);
+}
+
+void drawLine(DrawList& list, float x1, float y1, float x2, float y2, SDL_Color color) {
+    if (list.commands.size() == DRAW_MAX_COMMANDS) return;
+    DrawCommand cmd = {DrawType::LINE, {0, 0, 0, 0}, {x1, y1, x2 - x1, y2 - y1}, SDL_FLIP_NONE, color, 0, 0};
+    list.commands.push_back(cmd);
+}
+
+SDL_Vertex* beginQuads(DrawList& list, int maxQuads) {
+    if (list.commands.size() == DRAW_MAX_COMMANDS ||
+        list.vertexCount + maxQuads * 4 > static_cast<int>(list.vertices.size())) {
+        return NULL;
+    }
+    return &list.vertices[list.vertexCount];
+}
+
+void endQuads(DrawList& list, int quadCount) {
+    if (quadCount <= 0) return;
+    DrawCommand cmd = {DrawType::QUADS, {0, 0, 0, 0}, {0, 0, 0, 0}, SDL_FLIP_NONE, {255, 255, 255, 255},
+                       list.vertexCount, quadCount};
+    list.commands.push_back(cmd);
+    list.vertexCount += quadCount * 4;
+}
+
+void initSceneTarget(SceneTarget& scene, int width, int height, bool integerScale) {
+    scene.width = width;
+    scene.height = height;
+    scene.viewW = width;
+    scene.viewH = height;
+    scene.integerScale = integerScale;
+}
+
+void setSceneScale(SceneTarget& scene, float scale) {
+    scene.viewW = std::max(1, std::min(scene.width, static_cast<int>(scene.width * scale + 0.5f)));
+    scene.viewH = std::max(1, std::min(scene.height, static_cast<int>(scene.height * scale + 0.5f)));
+}
+
+SDL_Rect sceneOutputRect(const SceneTarget& scene, int outW, int outH) {
+    if (!scene.integerScale) return {0, 0, outW, outH};
+    // Largest whole-number scale that fits, centred
+    int scale = std::max(1, std::min(outW / scene.viewW, outH / scene.viewH));
+    return {
+        (outW - scene.viewW * scale) / 2,
+        (outH - scene.viewH * scale) / 2,
+        scene.viewW * scale,
+        scene.viewH * scale
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <vector>
+
+// Upper bounds the draw list is sized for up front
+const int DRAW_MAX_COMMANDS = 4096;
+const int DRAW_MAX_QUADS = 160000;
+
+//enum
+enum class DrawType {
+    SPRITE,
+    QUADS,
+    LINE
+};
+
+//structure
+// One render command in screen space. Sprites and quads sample the shared
+// atlas; quads are a run of list.vertices, four per quad.
+struct DrawCommand {
+    DrawType type;
+    SDL_Rect src;             // SPRITE: atlas pixels
+    SDL_FRect dst;            // SPRITE: destination; LINE: (x, y) to (x + w, y + h)
+    SDL_RendererFlip flip;
+    SDL_Color color;          // LINE: colour
+    int firstVertex, quadCount;
+};
+
+// Everything one frame draws, in order. Culling happens while this is built,
+// so nothing off-screen ever becomes a command.
+struct DrawList {
+    std::vector<DrawCommand> commands;
+    std::vector<SDL_Vertex> vertices;   // Sized to DRAW_MAX_QUADS * 4 once
+    int vertexCount;
+    std::vector<int> quadIndices;       // 0 1 2 2 3 0 pattern for every quad
+    SDL_Color clearColor;
+};
+
+// Optional offscreen scene. The scene is drawn into the top-left viewW x
+// viewH pixels of a width x height target with the logical screen scaled to
+// fit, then copied to the window. A fixed low resolution is shown at a
+// whole-number scale with nearest filtering; a dynamically sized one is
+// stretched to the window. Either way fill cost follows the target size
+// rather than the window size. The render backend owns the actual target.
+struct SceneTarget {
+    int width, height;        // Allocated size; 0 = draw straight to the window
+    int viewW, viewH;         // Part in use this frame
+    bool integerScale;
+};
+
+//function definaction
+void initDrawList(DrawList& list);
+void clearDrawList(DrawList& list, SDL_Color clearColor);
+void drawSprite(DrawList& list, const SDL_Rect& src, const SDL_FRect& dst, SDL_RendererFlip flip);
+void drawLine(DrawList& list, float x1, float y1, float x2, float y2, SDL_Color color);
+// Reserve room for up to maxQuads quads and return where to write them; close
+// with endQuads and the number actually written. Returns NULL when full.
+SDL_Vertex* beginQuads(DrawList& list, int maxQuads);
+void endQuads(DrawList& list, int quadCount);
+void initSceneTarget(SceneTarget& scene, int width, int height, bool integerScale);
+// Use the top-left fraction of the target on each axis
+void setSceneScale(SceneTarget& scene, float scale);
+// Where the part in use lands in an outW x outH window
+SDL_Rect sceneOutputRect(const SceneTarget& scene, int outW, int outH);
@@ -0,0 +1,38 @@
+#include "resolution.h"
+
+#include <algorithm>
+
+void initResolutionController(ResolutionController& ctrl, float minScale, float maxScale, float budgetMs) {
+    ctrl.minScale = minScale;
+    ctrl.maxScale = maxScale;
+    ctrl.scale = maxScale;
+    ctrl.budgetMs = budgetMs;
+    ctrl.averageMs = 0;
+    ctrl.cooldown = DYNRES_COOLDOWN;
+    ctrl.changes = 0;
+}
+
+bool updateResolution(ResolutionController& ctrl, float renderMs) {
+    ctrl.averageMs += (renderMs - ctrl.averageMs) * DYNRES_SMOOTHING;
+    if (ctrl.cooldown > 0) {
+        ctrl.cooldown--;
+        return false;
+    }
+
+    float scale = ctrl.scale;
+    if (ctrl.averageMs > ctrl.budgetMs * DYNRES_HIGH_WATER) {
+        scale = std::max(ctrl.minScale, scale - DYNRES_STEP);
+    } else if (ctrl.averageMs < ctrl.budgetMs * DYNRES_LOW_WATER) {
+        scale = std::min(ctrl.maxScale, scale + DYNRES_STEP);
+    }
+    if (scale == ctrl.scale) return false;
+
+    // Render cost roughly tracks pixel count; restart the average from there
+    // so the next decision isn't made on samples from the old size
+    float ratio = (scale * scale) / (ctrl.scale * ctrl.scale);
+    ctrl.averageMs *= ratio;
+    ctrl.scale = scale;
+    ctrl.cooldown = DYNRES_COOLDOWN;
+    ctrl.changes++;
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Render time above budget * DYNRES_HIGH_WATER shrinks the scene target,
+// below budget * DYNRES_LOW_WATER grows it; the gap is the hysteresis
+const float DYNRES_HIGH_WATER = 1.0f;
+const float DYNRES_LOW_WATER = 0.7f;
+const float DYNRES_STEP = 0.1f;        // Scale change per adjustment
+const int DYNRES_COOLDOWN = 30;        // Frames to settle after a change
+const float DYNRES_SMOOTHING = 0.1f;   // EMA weight of the newest sample
+
+//structure
+// Picks the scene target size from recent render times. scale is the
+// fraction of the full target size used on each axis.
+struct ResolutionController {
+    float scale;
+    float minScale, maxScale;
+    float budgetMs;
+    float averageMs;
+    int cooldown;
+    unsigned changes;
+};
+
+//function definaction
+void initResolutionController(ResolutionController& ctrl, float minScale, float maxScale, float budgetMs);
+// Feed one frame's render time; true when the scale changed
+bool updateResolution(ResolutionController& ctrl, float renderMs);
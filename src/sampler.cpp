@@ -0,0 +1,203 @@
+#include "sampler.h"
+#include "log.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <sched.h>
+#include <signal.h>
+#include <string>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// The signal handler and the frames it interrupts into: skipped
+static const int SAMPLER_SKIP = 2;
+
+struct Sample {
+    int depth;
+    pid_t tid;
+    void* frames[SAMPLER_MAX_DEPTH];
+};
+
+static Sample* samples = NULL;
+static std::atomic<int> sampleCount(0);
+static std::atomic<int> dropped(0);
+static std::atomic<bool> sampling(false);
+// Handlers past their entry; stopSampler waits for this to drain before it
+// reads or frees the buffer
+static std::atomic<int> handlersRunning(0);
+static struct sigaction previousAction;
+static char outputPath[256];
+
+// Runs on whichever thread the kernel interrupted. Only touches preallocated
+// memory; backtrace was called once up front so it has nothing left to load.
+static void onSample(int, siginfo_t*, void*) {
+    // Announce before checking, so a stop that has cleared sampling either
+    // sees this handler running or this handler sees sampling cleared
+    handlersRunning.fetch_add(1);
+    if (!sampling.load()) {
+        handlersRunning.fetch_sub(1);
+        return;
+    }
+    int saved = errno;
+    int index = sampleCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= SAMPLER_MAX_SAMPLES) {
+        sampleCount.store(SAMPLER_MAX_SAMPLES, std::memory_order_relaxed);
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        Sample& s = samples[index];
+        s.tid = static_cast<pid_t>(syscall(SYS_gettid));
+        s.depth = backtrace(s.frames, SAMPLER_MAX_DEPTH);
+    }
+    errno = saved;
+    handlersRunning.fetch_sub(1);
+}
+
+bool startSampler(int hz, const char* path) {
+    if (samples || hz <= 0) return false;
+    samples = static_cast<Sample*>(calloc(SAMPLER_MAX_SAMPLES, sizeof(Sample)));
+    if (!samples) {
+        LOG_ERROR(LogCategory::PERF, "Failed to allocate sample buffer");
+        return false;
+    }
+    snprintf(outputPath, sizeof(outputPath), "%s", path);
+
+    // The first backtrace may dlopen the unwinder, which isn't signal safe
+    void* warmup[4];
+    backtrace(warmup, 4);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onSample;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &previousAction) != 0) {
+        LOG_ERROR(LogCategory::PERF, "sigaction(SIGPROF) failed: {}", strerror(errno));
+        free(samples);
+        samples = NULL;
+        return false;
+    }
+
+    sampling.store(true);
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = std::max(1, 1000000 / hz);
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        LOG_ERROR(LogCategory::PERF, "setitimer failed: {}", strerror(errno));
+        sampling.store(false);
+        sigaction(SIGPROF, &previousAction, NULL);
+        free(samples);
+        samples = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Demangled function name, or module+offset when the symbol isn't exported
+static std::string symbolize(void* address) {
+    Dl_info info;
+    char buffer[64];
+    if (!dladdr(address, &info) || !info.dli_fname) {
+        snprintf(buffer, sizeof(buffer), "%p", address);
+        return buffer;
+    }
+    if (info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+        std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+        free(demangled);
+        return name;
+    }
+    const char* module = strrchr(info.dli_fname, '/');
+    module = module ? module + 1 : info.dli_fname;
+    snprintf(buffer, sizeof(buffer), "+0x%lx",
+             static_cast<unsigned long>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+    return std::string(module) + buffer;
+}
+
+// The thread's name from /proc, e.g. "job worker", so workers fold together
+static std::string threadName(pid_t tid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/comm", static_cast<int>(tid));
+    char name[64] = "";
+    FILE* file = fopen(path, "r");
+    if (file) {
+        if (!fgets(name, sizeof(name), file)) name[0] = 0;
+        fclose(file);
+    }
+    name[strcspn(name, "\n")] = 0;
+    if (!name[0]) snprintf(name, sizeof(name), "thread %d", static_cast<int>(tid));
+    return name;
+}
+
+void stopSampler() {
+    if (!samples) return;
+    struct itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, NULL);
+    sampling.store(false);
+    // A SIGPROF already generated may still be on its way; under the usual
+    // previous action (SIG_DFL) it would kill the process, so ignore it
+    struct sigaction ignore;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPROF, &ignore, NULL);
+    while (handlersRunning.load() > 0) sched_yield();
+
+    // Folded stacks: root first, frames joined by ';', then the count
+    int count = std::min(sampleCount.load(), SAMPLER_MAX_SAMPLES);
+    std::map<void*, std::string> symbols;
+    std::map<pid_t, std::string> threads;
+    std::map<std::string, int> folded;
+    for (int i = 0; i < count; i++) {
+        const Sample& s = samples[i];
+        if (s.depth <= SAMPLER_SKIP) continue;
+        auto thread = threads.find(s.tid);
+        if (thread == threads.end()) thread = threads.emplace(s.tid, threadName(s.tid)).first;
+        std::string stack = thread->second;
+        for (int f = s.depth - 1; f >= SAMPLER_SKIP; f--) {
+            auto symbol = symbols.find(s.frames[f]);
+            if (symbol == symbols.end()) symbol = symbols.emplace(s.frames[f], symbolize(s.frames[f])).first;
+            stack += ';';
+            stack += symbol->second;
+        }
+        folded[stack]++;
+    }
+
+    FILE* file = fopen(outputPath, "w");
+    if (file) {
+        for (const auto& entry : folded) fprintf(file, "%s %d\n", entry.first.c_str(), entry.second);
+        fclose(file);
+        std::cout << "Sampler: " << count << " samples (" << dropped.load() << " dropped), "
+                  << folded.size() << " unique stacks written to " << outputPath << std::endl;
+    } else {
+        LOG_ERROR(LogCategory::PERF, "Failed to open sample file {}", outputPath);
+    }
+    free(samples);
+    samples = NULL;
+}
+
+#else
+
+bool startSampler(int, const char*) {
+    LOG_WARN(LogCategory::PERF, "The sampling profiler needs Linux (setitimer/SIGPROF)");
+    return false;
+}
+
+void stopSampler() {
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#include "SDL2/SDL.h"
+
+// Preallocated sample storage; samples past the end are counted and dropped
+const int SAMPLER_MAX_SAMPLES = 1 << 16;
+const int SAMPLER_MAX_DEPTH = 48;
+const int SAMPLER_DEFAULT_HZ = 997;   // Off the beat of 60 Hz frames
+
+//function definaction
+// Linux only: sample the call stack of whichever game thread is using CPU,
+// hz times per CPU-second, via setitimer(ITIMER_PROF) and SIGPROF. The
+// kernel may deliver at its tick rate instead if that is lower. Elsewhere
+// this reports that it is unsupported and returns false.
+bool startSampler(int hz, const char* path);
+// Stop sampling, symbolize and write folded stacks ("root;caller;callee
+// count" per line) to the path given to startSampler, ready for
+// flamegraph.pl or speedscope. Function names in the executable itself
+// need it linked with -rdynamic; otherwise they show as module+offset.
+// Call once worker threads have stopped; SIGPROF stays ignored afterwards.
+void stopSampler();
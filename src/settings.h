@@ -1,15 +1,50 @@
-#pragma "once"
+#pragma once
 #include "SDL2/SDL.h"
 #include "SDL2/SDL_image.h"
 #include <vector>
 #include <iostream>
+#include "collision.h"
+#include "spritemask.h"
+#include "atlas.h"
+#include "input.h"
+#include "jobs.h"
+#include "projectiles.h"
+#include "particles.h"
+#include "camera.h"
+#include "render.h"
+#include "backend.h"
+#include "resolution.h"
+#include "telemetry.h"
+#include "hud.h"
+#include "text.h"
+#include "overlay.h"
+#include "memory.h"
+#include "profiler.h"
+#include "sampler.h"
+#include "perfcounters.h"
+#include "arena.h"
+#include "log.h"
 // Game constants
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
+const int WORLD_WIDTH = 2560;  // The level scrolls; the screen shows part of it
+const int WORLD_HEIGHT = 480;
 const float GRAVITY = 0.5f;
 const float JUMP_FORCE = -12.0f;
 const float PLAYER_SPEED = 5.0f;
 const int ANIMATION_FRAME_DURATION = 150; // ms
+const float RENDER_BUDGET_MS = 10.0f;      // Dynamic resolution aims to render within this
+const float DYNRES_MIN = 0.5f;             // Dynamic resolution bounds, fraction of window size
+const float DYNRES_MAX = 1.0f;
+const int FRAME_WIDTH = 50;   // Sprite sheet cell size
+const int FRAME_HEIGHT = 37;
+const int PLAYER_WIDTH = 50;  // Size the player is drawn at
+const int PLAYER_HEIGHT = 50;
+const int PLAYER_MAX_HEALTH = 5;
+const float PLAYER_MAX_STAMINA = 100.0f;
+const float ATTACK_STAMINA = 20.0f;        // Spent per shot; no shot without it
+const float STAMINA_REGEN = 0.02f;         // Per ms
+const double PLAYER_HIT_COOLDOWN = 1000.0; // ms the player can't be hurt again after a hit
 
 //enum
 enum class AnimationState {
@@ -27,6 +62,8 @@ struct Player {
     int width, height;
     AnimationState state;
     bool facingRight;
+    int health, maxHealth;
+    float stamina;
 };
 
 struct Animation {
@@ -36,22 +73,83 @@ struct Animation {
     int framesPerRow;     // Frames per row if multiRow is true
 };
 
+// Command-line options
+struct Options {
+    bool measureLatency = false; // --latency: report input-to-present latency at exit
+    int injectInterval = 0; // --inject N: synthetic key tap every N frames
+    int maxFrames = 0; // --frames N: quit after N frames, 0 = run until closed
+    int threads = 0; // --threads N: job workers including the main thread, 0 = per CPU
+    bool deterministic = false; // --deterministic: thread-count independent job chunking
+    bool benchJobs = false; // --bench-jobs: run the job scaling benchmark and exit
+    int stressProjectiles = 0; // --stress-projectiles N: keep N projectiles alive
+    int internalW = 0, internalH = 0; // --internal-res WxH: draw the scene at this size, 0 = window size
+    bool dynamicResolution = false; // --dynamic-res: scale the scene target to hold RENDER_BUDGET_MS
+    const char* telemetryPath = NULL; // --telemetry FILE: per-frame CSV
+    BackendType backend = BackendType::AUTO; // --backend NAME: renderer, software, surface, null or auto (probe)
+    bool benchRender = false; // --bench-render: time every backend on synthetic scenes and exit
+    bool benchBlit = false; // --bench-blit: validate and time the CPU blit kernels and exit
+    bool benchRaster = false; // --bench-raster: tiled rasteriser scaling up to --threads (or 16) and exit
+    bool dirtyRects = false; // --dirty-rects: surface backend redraws and presents only damaged tiles
+    bool benchText = false; // --bench-text: time text layout and batching for an overlay and exit
+    bool overlay = false; // --overlay: start with the performance overlay shown (F3 toggles)
+    int traceFrames = 0; // --trace N: capture the first N frames; F4 captures N (or 60) more
+    const char* tracePath = "trace.json"; // --trace-file FILE: where captures go, default trace.json
+    int sampleHz = 0; // --sample [HZ]: SIGPROF sampling profiler (Linux), 0 = off
+    const char* samplePath = "samples.folded"; // --sample-file FILE: folded stacks, default samples.folded
+    bool perfCounters = false; // --perf-counters: per-phase hardware counters (Linux), software ones without a PMU
+    bool assertNoAlloc = false; // --assert-no-alloc [WARMUP]: abort on a heap allocation after the warm-up frames
+    int allocWarmup = MEMORY_WARMUP_FRAMES; // Frames --assert-no-alloc lets allocate, default MEMORY_WARMUP_FRAMES
+    bool allocReport = false; // --alloc-report: main-loop heap traffic per thread (and call site in debug builds) at exit
+    int arenaKB = FRAME_ARENA_DEFAULT_KB; // --arena-kb N: per-thread frame arena size, 0 = none
+    bool hugePages = false; // --huge-pages: back the frame arenas with huge pages where the OS allows
+};
+
 struct Game {
     SDL_Window* window;
-    SDL_Renderer* renderer;
-    SDL_Texture* playerTexture;
+    RenderBackend backend;
+    Atlas atlas;
+    std::vector<int> playerFrames;  // Atlas region per sheet cell
+    int sheetColumns;
     Player player;
     float groundY;
     std::vector<Animation> animations;
     int currentAnimIndex;
     int animFrame;
     double animTimer;
+    CollisionWorld world;
+    int groundCollider;
+    int playerCollider;
+    SheetMasks playerMasks;
+    SpriteMask projectileMask;      // PROJECTILE_SIZE square
+    InputSystem input;
+    JobSystem jobs;
+    ProjectilePool projectiles;
+    int stressProjectiles;
+    double hitCooldown;             // ms until the player can be hurt again
+    ParticleSystem particles;
+    PoolHandle dustEmitter;
+    PoolHandle sparkEmitter;
+    Camera camera;
+    DrawList drawList;
+    SceneTarget scene;
+    bool dynamicResolution;
+    ResolutionController resolution;
+    FrameStats stats;
+    Hud hud;
+    Font font;
+    TextCache text;
+    PerfOverlay overlay;
 };
 //function definaction
 bool initSDL(Game& game);
 bool loadResources(Game& game);
 void initGame(Game& game);
-void handleInput(Game& game, const Uint8* keys);
+void handleInput(Game& game, const ActionState& input);
 void updateGame(Game& game, double deltaTime);
+void buildDrawList(Game& game);
 void renderGame(Game& game);
+void presentGame(Game& game);
 void cleanup(Game& game);
+void animationCell(const Animation& anim, int frame, int& row, int& col);
+const SpriteMask& playerMask(const Game& game);
+bool playerPixelOverlap(const Game& game, const SpriteMask& mask, int x, int y);
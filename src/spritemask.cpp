@@ -0,0 +1,102 @@
+#include "spritemask.h"
+#include "log.h"
+
+#include <algorithm>
+
+// Resample one sheet cell to drawW x drawH (nearest neighbour)
+static void buildMask(const SDL_Surface* sheet, int cellX, int cellY, int frameW, int frameH,
+                      int drawW, int drawH, bool flip, SpriteMask& mask) {
+    mask.width = drawW;
+    mask.height = drawH;
+    mask.wordsPerRow = (drawW + 63) / 64;
+    mask.bits.assign(static_cast<size_t>(mask.wordsPerRow) * drawH, 0);
+
+    for (int y = 0; y < drawH; y++) {
+        int sy = cellY + y * frameH / drawH;
+        const Uint32* src = reinterpret_cast<const Uint32*>(
+            static_cast<const Uint8*>(sheet->pixels) + sy * sheet->pitch);
+        uint64_t* row = &mask.bits[static_cast<size_t>(y) * mask.wordsPerRow];
+        for (int x = 0; x < drawW; x++) {
+            int sx = x * frameW / drawW;
+            if (flip) sx = frameW - 1 - sx;
+            Uint8 alpha = src[cellX + sx] >> 24;
+            if (alpha >= MASK_ALPHA_THRESHOLD) {
+                row[x >> 6] |= uint64_t(1) << (x & 63);
+            }
+        }
+    }
+}
+
+bool buildSheetMasks(SDL_Surface* sheet, int frameW, int frameH, int drawW, int drawH, SheetMasks& masks) {
+    // ARGB8888 is a packed format, so alpha is the top byte on any endianness
+    SDL_Surface* argb = SDL_ConvertSurfaceFormat(sheet, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!argb) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to convert sheet for masks: {}", SDL_GetError());
+        return false;
+    }
+    SDL_LockSurface(argb);
+
+    masks.columns = argb->w / frameW;
+    masks.rows = argb->h / frameH;
+    int cells = masks.columns * masks.rows;
+    masks.normal.resize(cells);
+    masks.flipped.resize(cells);
+    for (int r = 0; r < masks.rows; r++) {
+        for (int c = 0; c < masks.columns; c++) {
+            int i = r * masks.columns + c;
+            buildMask(argb, c * frameW, r * frameH, frameW, frameH, drawW, drawH, false, masks.normal[i]);
+            buildMask(argb, c * frameW, r * frameH, frameW, frameH, drawW, drawH, true, masks.flipped[i]);
+        }
+    }
+
+    SDL_UnlockSurface(argb);
+    SDL_FreeSurface(argb);
+    return true;
+}
+
+const SpriteMask& sheetMask(const SheetMasks& masks, int row, int col, bool flipped) {
+    int i = row * masks.columns + col;
+    return flipped ? masks.flipped[i] : masks.normal[i];
+}
+
+void buildSolidMask(SpriteMask& mask, int width, int height) {
+    mask.width = width;
+    mask.height = height;
+    mask.wordsPerRow = (width + 63) / 64;
+    mask.bits.assign(static_cast<size_t>(mask.wordsPerRow) * height, 0);
+    for (int y = 0; y < height; y++) {
+        uint64_t* row = &mask.bits[static_cast<size_t>(y) * mask.wordsPerRow];
+        for (int x = 0; x < width; x++) row[x >> 6] |= uint64_t(1) << (x & 63);
+    }
+}
+
+// 64 bits of a mask row starting at pixel 'start'; pixels outside the row are 0
+static inline uint64_t rowBits(const uint64_t* row, int words, int start) {
+    int q = start >> 6;    // floor division, also for negative starts
+    int r = start & 63;
+    uint64_t lo = (q >= 0 && q < words) ? row[q] : 0;
+    if (r == 0) return lo;
+    uint64_t hi = (q + 1 >= 0 && q + 1 < words) ? row[q + 1] : 0;
+    return (lo >> r) | (hi << (64 - r));
+}
+
+bool masksOverlap(const SpriteMask& a, int ax, int ay, const SpriteMask& b, int bx, int by) {
+    int y0 = std::max(ay, by);
+    int y1 = std::min(ay + a.height, by + b.height);
+    int x0 = std::max(ax, bx);
+    int x1 = std::min(ax + a.width, bx + b.width);
+    if (y0 >= y1 || x0 >= x1) return false;
+
+    // Only a's words that cover the shared columns need testing
+    int w0 = (x0 - ax) >> 6;
+    int w1 = (x1 - ax - 1) >> 6;
+    int dx = bx - ax;
+    for (int y = y0; y < y1; y++) {
+        const uint64_t* rowA = &a.bits[static_cast<size_t>(y - ay) * a.wordsPerRow];
+        const uint64_t* rowB = &b.bits[static_cast<size_t>(y - by) * b.wordsPerRow];
+        for (int w = w0; w <= w1; w++) {
+            if (rowA[w] & rowBits(rowB, b.wordsPerRow, w * 64 - dx)) return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include <vector>
+#include <cstdint>
+
+// Alpha at or above this counts as solid
+const Uint8 MASK_ALPHA_THRESHOLD = 128;
+
+//structure
+// 1-bit coverage mask. Rows are padded to whole 64-bit words; bit i of a row
+// (LSB first) is pixel x = i.
+struct SpriteMask {
+    int width, height;
+    int wordsPerRow;
+    std::vector<uint64_t> bits;
+};
+
+// Masks for every cell of a sprite sheet, resampled to the size the cells are
+// drawn at, in both facings
+struct SheetMasks {
+    int columns, rows;
+    std::vector<SpriteMask> normal;
+    std::vector<SpriteMask> flipped;
+};
+
+//function definaction
+bool buildSheetMasks(SDL_Surface* sheet, int frameW, int frameH, int drawW, int drawH, SheetMasks& masks);
+const SpriteMask& sheetMask(const SheetMasks& masks, int row, int col, bool flipped);
+// Fully solid width x height mask, for shapes with no sprite behind them
+void buildSolidMask(SpriteMask& mask, int width, int height);
+// Pixel-exact overlap of two masks placed with their top-left corners at
+// (ax, ay) and (bx, by)
+bool masksOverlap(const SpriteMask& a, int ax, int ay, const SpriteMask& b, int bx, int by);
@@ -0,0 +1,100 @@
+#include "telemetry.h"
+#include "log.h"
+
+#include <iostream>
+
+const char* phaseName(Phase phase) {
+    switch (phase) {
+    case Phase::INPUT: return "input";
+    case Phase::UPDATE: return "update";
+    case Phase::RENDER: return "render";
+    case Phase::PRESENT: return "present";
+    default: return "?";
+    }
+}
+
+bool openTelemetry(Telemetry& telemetry, const char* path, const PerfCounters& counters) {
+    telemetry.hardware = counters.hardware;
+    telemetry.software = counters.software;
+    telemetry.csv = fopen(path, "w");
+    if (!telemetry.csv) {
+        LOG_ERROR(LogCategory::PERF, "Failed to open telemetry file {}", path);
+        return false;
+    }
+    fprintf(telemetry.csv, "frame,frame_ms");
+    for (int p = 0; p < static_cast<int>(Phase::COUNT); p++) {
+        fprintf(telemetry.csv, ",%s_ms", phaseName(static_cast<Phase>(p)));
+    }
+    fprintf(telemetry.csv, ",render_scale,scene_w,scene_h,draw_commands,sprites,quads,projectiles,particles");
+    fprintf(telemetry.csv, ",damage,hud_redrawn,allocations,allocated_bytes,arena_bytes");
+    for (int p = 0; p < static_cast<int>(Phase::COUNT); p++) {
+        const char* name = phaseName(static_cast<Phase>(p));
+        if (telemetry.hardware) fprintf(telemetry.csv, ",%s_ipc,%s_cache_mpki,%s_branch_mpki", name, name, name);
+        if (telemetry.software) fprintf(telemetry.csv, ",%s_cpu_ms,%s_page_faults,%s_context_switches", name, name, name);
+    }
+    fprintf(telemetry.csv, "\n");
+    return true;
+}
+
+void writeTelemetry(Telemetry& telemetry, const FrameStats& stats) {
+    if (!telemetry.csv) return;
+    fprintf(telemetry.csv, "%u,%.3f", stats.frame, stats.frameMs);
+    for (int p = 0; p < static_cast<int>(Phase::COUNT); p++) {
+        fprintf(telemetry.csv, ",%.3f", stats.phaseMs[p]);
+    }
+    fprintf(telemetry.csv, ",%.2f,%d,%d,%d,%d,%d,%d,%d,%.3f,%d,%d,%d,%d", stats.renderScale, stats.sceneW,
+            stats.sceneH, stats.drawCommands, stats.sprites, stats.quads, stats.projectiles, stats.particles, stats.damage,
+            stats.hudRedrawn ? 1 : 0, stats.allocations, stats.allocatedBytes, stats.arenaBytes);
+    for (int p = 0; p < static_cast<int>(Phase::COUNT); p++) {
+        const Uint64* events = stats.phaseEvents[p];
+        if (telemetry.hardware) {
+            fprintf(telemetry.csv, ",%.3f,%.3f,%.3f", perfIpc(events), perfPerKilo(events, PerfCounter::CACHE_MISSES),
+                    perfPerKilo(events, PerfCounter::BRANCH_MISSES));
+        }
+        if (telemetry.software) {
+            fprintf(telemetry.csv, ",%.3f,%llu,%llu", events[static_cast<int>(PerfCounter::TASK_CLOCK)] / 1e6,
+                    static_cast<unsigned long long>(events[static_cast<int>(PerfCounter::PAGE_FAULTS)]),
+                    static_cast<unsigned long long>(events[static_cast<int>(PerfCounter::CONTEXT_SWITCHES)]));
+        }
+    }
+    fprintf(telemetry.csv, "\n");
+}
+
+void closeTelemetry(Telemetry& telemetry) {
+    if (telemetry.csv) fclose(telemetry.csv);
+    telemetry.csv = NULL;
+}
+
+void addPhaseReport(PhaseReport& report, const FrameStats& stats) {
+    report.frames++;
+    for (int p = 0; p < static_cast<int>(Phase::COUNT); p++) {
+        report.phaseMs[p] += stats.phaseMs[p];
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            report.phaseEvents[p][i] += stats.phaseEvents[p][i];
+        }
+    }
+}
+
+void printPhaseReport(const PhaseReport& report, const PerfCounters& counters) {
+    if (report.frames == 0) return;
+    std::cout << "Phase counters over " << report.frames << " frames"
+              << (counters.hardware ? "" : " (no PMU access, software counters only)") << ":" << std::endl;
+    for (int p = 0; p < static_cast<int>(Phase::COUNT); p++) {
+        const Uint64* events = report.phaseEvents[p];
+        char line[192];
+        int n = snprintf(line, sizeof(line), "  %-8s %7.3f ms", phaseName(static_cast<Phase>(p)),
+                         report.phaseMs[p] / report.frames);
+        if (counters.hardware && n > 0) {
+            n += snprintf(line + n, sizeof(line) - n, "  ipc %5.2f  cache miss/ki %6.2f  branch miss/ki %6.2f",
+                          perfIpc(events), perfPerKilo(events, PerfCounter::CACHE_MISSES),
+                          perfPerKilo(events, PerfCounter::BRANCH_MISSES));
+        }
+        if (counters.software && n > 0) {
+            snprintf(line + n, sizeof(line) - n, "  cpu %7.3f ms  faults %6.1f  switches %5.2f",
+                     events[static_cast<int>(PerfCounter::TASK_CLOCK)] / 1e6 / report.frames,
+                     static_cast<double>(events[static_cast<int>(PerfCounter::PAGE_FAULTS)]) / report.frames,
+                     static_cast<double>(events[static_cast<int>(PerfCounter::CONTEXT_SWITCHES)]) / report.frames);
+        }
+        std::cout << line << std::endl;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "perfcounters.h"
+#include <cstdio>
+
+//enum
+enum class Phase {
+    INPUT,
+    UPDATE,
+    RENDER,
+    PRESENT,
+    COUNT
+};
+
+//structure
+// What one frame cost and drew
+struct FrameStats {
+    Uint32 frame;
+    double frameMs;
+    double phaseMs[static_cast<int>(Phase::COUNT)];
+    float renderScale;        // Fraction of the scene target in use
+    int sceneW, sceneH;       // Pixels the scene was drawn at
+    int drawCommands;
+    int sprites;
+    int quads;
+    int projectiles;
+    int particles;
+    float damage;             // Share of the frame redrawn (1 unless dirty rects are on)
+    bool hudRedrawn;          // The HUD's cached layer had to be redrawn
+    int allocations;          // Heap allocations during the frame
+    int allocatedBytes;
+    int arenaBytes;           // Frame arena use over all threads
+    // Counter deltas per phase; zero for counters that aren't open
+    Uint64 phaseEvents[static_cast<int>(Phase::COUNT)][PERF_COUNTER_COUNT];
+};
+
+// Per-frame CSV log, one row per frame. Per-phase counter columns are added
+// for whichever counters were open.
+struct Telemetry {
+    FILE* csv;
+    bool hardware, software;
+};
+
+// Run totals for the exit report
+struct PhaseReport {
+    Uint64 frames;
+    double phaseMs[static_cast<int>(Phase::COUNT)];
+    Uint64 phaseEvents[static_cast<int>(Phase::COUNT)][PERF_COUNTER_COUNT];
+};
+
+//function definaction
+const char* phaseName(Phase phase);
+bool openTelemetry(Telemetry& telemetry, const char* path, const PerfCounters& counters);
+void writeTelemetry(Telemetry& telemetry, const FrameStats& stats);
+void closeTelemetry(Telemetry& telemetry);
+void addPhaseReport(PhaseReport& report, const FrameStats& stats);
+// Average time per phase with its IPC and cache and branch misses per
+// thousand instructions, or CPU time, faults and switches without a PMU
+void printPhaseReport(const PhaseReport& report, const PerfCounters& counters);
+
+// Milliseconds since a SDL_GetPerformanceCounter() reading
+inline double elapsedMs(Uint64 start) {
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
@@ -0,0 +1,226 @@
+#include "text.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+
+// One byte per row, bit 4 = leftmost column
+static const Uint8 FONT_BITS[FONT_GLYPHS][FONT_GLYPH_H] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04},  // !
+    {0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00},  // "
+    {0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a},  // #
+    {0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04},  // $
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},  // %
+    {0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d},  // &
+    {0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00},  // '
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02},  // (
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},  // )
+    {0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00},  // *
+    {0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00},  // +
+    {0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08},  // ,
+    {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00},  // -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c},  // .
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},  // /
+    {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e},  // 0
+    {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e},  // 1
+    {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f},  // 2
+    {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e},  // 3
+    {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02},  // 4
+    {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e},  // 5
+    {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e},  // 6
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},  // 7
+    {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e},  // 8
+    {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c},  // 9
+    {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00},  // :
+    {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08},  // ;
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02},  // <
+    {0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00},  // =
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08},  // >
+    {0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04},  // ?
+    {0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e},  // @
+    {0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},  // A
+    {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},  // B
+    {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e},  // C
+    {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},  // D
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f},  // E
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},  // F
+    {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f},  // G
+    {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},  // H
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},  // I
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},  // J
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},  // K
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},  // L
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11},  // M
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},  // N
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},  // O
+    {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},  // P
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d},  // Q
+    {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},  // R
+    {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e},  // S
+    {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},  // T
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},  // U
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},  // V
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a},  // W
+    {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},  // X
+    {0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04},  // Y
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},  // Z
+    {0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e},  // [
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00},  // backslash
+    {0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e},  // ]
+    {0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00},  // ^
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f},  // _
+    {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00},  // `
+    {0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f},  // a
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e},  // b
+    {0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e},  // c
+    {0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f},  // d
+    {0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e},  // e
+    {0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08},  // f
+    {0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x0e},  // g
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11},  // h
+    {0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e},  // i
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0c},  // j
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12},  // k
+    {0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},  // l
+    {0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11},  // m
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11},  // n
+    {0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e},  // o
+    {0x00, 0x00, 0x1e, 0x11, 0x1e, 0x10, 0x10},  // p
+    {0x00, 0x00, 0x0d, 0x13, 0x0f, 0x01, 0x01},  // q
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10},  // r
+    {0x00, 0x00, 0x0e, 0x10, 0x0e, 0x01, 0x1e},  // s
+    {0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06},  // t
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d},  // u
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04},  // v
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a},  // w
+    {0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11},  // x
+    {0x00, 0x00, 0x11, 0x11, 0x0f, 0x01, 0x0e},  // y
+    {0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f},  // z
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02},  // {
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},  // |
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08},  // }
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00},  // ~
+};
+
+bool loadFont(Font& font, Atlas& atlas) {
+    SDL_Surface* glyph = SDL_CreateRGBSurfaceWithFormat(0, FONT_GLYPH_W, FONT_GLYPH_H, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!glyph) {
+        LOG_ERROR(LogCategory::ASSETS, "Failed to create glyph: {}", SDL_GetError());
+        return false;
+    }
+    SDL_Rect rect = {0, 0, FONT_GLYPH_W, FONT_GLYPH_H};
+    for (int g = 0; g < FONT_GLYPHS; g++) {
+        // White, so vertex colours tint it
+        for (int y = 0; y < FONT_GLYPH_H; y++) {
+            Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(glyph->pixels) + y * glyph->pitch);
+            for (int x = 0; x < FONT_GLYPH_W; x++) {
+                row[x] = (FONT_BITS[g][y] >> (FONT_GLYPH_W - 1 - x)) & 1 ? 0xffffffffu : 0x00ffffffu;
+            }
+        }
+        font.regions[g] = atlasAdd(atlas, glyph, rect);
+        if (font.regions[g] < 0) {
+            SDL_FreeSurface(glyph);
+            return false;
+        }
+    }
+    SDL_FreeSurface(glyph);
+    return true;
+}
+
+void initTextCache(TextCache& cache) {
+    cache.slots.resize(TEXT_CACHE_SLOTS);
+    cache.vertices.resize(TEXT_CACHE_SLOTS * TEXT_MAX_LENGTH * 4);
+    clearTextCache(cache);
+}
+
+void clearTextCache(TextCache& cache) {
+    for (TextLayout& layout : cache.slots) layout.length = 0;
+    cache.hits = 0;
+    cache.misses = 0;
+}
+
+// FNV-1a over the string; also measures it
+static Uint64 hashText(const char* text, int& length) {
+    Uint64 h = 0xcbf29ce484222325ull;
+    int n = 0;
+    for (; text[n] && n < TEXT_MAX_LENGTH; n++) {
+        h = (h ^ static_cast<Uint8>(text[n])) * 0x100000001b3ull;
+    }
+    length = n;
+    return h;
+}
+
+static void buildLayout(TextLayout& layout, SDL_Vertex* out, const Font& font, const Atlas& atlas) {
+    float invW = 1.0f / atlas.width, invH = 1.0f / atlas.height;
+    SDL_Color white = {255, 255, 255, 255};
+    int quads = 0;
+    int column = 0, line = 0, widest = 0;
+    for (int i = 0; i < layout.length; i++) {
+        int c = static_cast<Uint8>(layout.text[i]);
+        if (c == '\n') {
+            column = 0;
+            line++;
+            continue;
+        }
+        if (c != ' ') {
+            int g = c >= FONT_FIRST && c < FONT_FIRST + FONT_GLYPHS ? c - FONT_FIRST : '?' - FONT_FIRST;
+            const SDL_Rect& r = atlas.regions[font.regions[g]].rect;
+            float u0 = r.x * invW, v0 = r.y * invH;
+            float u1 = (r.x + r.w) * invW, v1 = (r.y + r.h) * invH;
+            float x0 = static_cast<float>(column * FONT_ADVANCE), y0 = static_cast<float>(line * FONT_LINE);
+            float x1 = x0 + FONT_GLYPH_W, y1 = y0 + FONT_GLYPH_H;
+
+            SDL_Vertex* q = &out[quads * 4];
+            q[0] = {{x0, y0}, white, {u0, v0}};
+            q[1] = {{x1, y0}, white, {u1, v0}};
+            q[2] = {{x1, y1}, white, {u1, v1}};
+            q[3] = {{x0, y1}, white, {u0, v1}};
+            quads++;
+        }
+        column++;
+        widest = std::max(widest, column);
+    }
+    layout.quadCount = quads;
+    layout.width = static_cast<float>(widest > 0 ? widest * FONT_ADVANCE - 1 : 0);
+    layout.height = static_cast<float>(layout.length > 0 ? line * FONT_LINE + FONT_GLYPH_H : 0);
+}
+
+const TextLayout& layoutText(TextCache& cache, const Font& font, const Atlas& atlas, const char* text) {
+    int length;
+    Uint64 hash = hashText(text, length);
+    int slot = static_cast<int>(hash & (TEXT_CACHE_SLOTS - 1));
+    TextLayout& layout = cache.slots[slot];
+    if (layout.length == length && layout.hash == hash && memcmp(layout.text, text, length) == 0) {
+        cache.hits++;
+        return layout;
+    }
+
+    // Miss: this string takes the slot over
+    cache.misses++;
+    layout.hash = hash;
+    layout.length = length;
+    memcpy(layout.text, text, length);
+    layout.firstVertex = slot * TEXT_MAX_LENGTH * 4;
+    buildLayout(layout, &cache.vertices[layout.firstVertex], font, atlas);
+    return layout;
+}
+
+float drawText(DrawList& list, TextCache& cache, const Font& font, const Atlas& atlas, const char* text,
+               float x, float y, float scale, SDL_Color color) {
+    const TextLayout& layout = layoutText(cache, font, atlas, text);
+    if (layout.quadCount == 0) return layout.width * scale;
+    SDL_Vertex* out = beginQuads(list, layout.quadCount);
+    if (!out) return 0;
+
+    // Place, scale and tint the cached quads
+    const SDL_Vertex* in = &cache.vertices[layout.firstVertex];
+    for (int i = 0; i < layout.quadCount * 4; i++) {
+        out[i].position.x = x + in[i].position.x * scale;
+        out[i].position.y = y + in[i].position.y * scale;
+        out[i].color = color;
+        out[i].tex_coord = in[i].tex_coord;
+    }
+    endQuads(list, layout.quadCount);
+    return layout.width * scale;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "atlas.h"
+#include "render.h"
+#include <vector>
+
+// Built-in 5x7 font covering printable ASCII
+const int FONT_FIRST = 32;
+const int FONT_GLYPHS = 95;
+const int FONT_GLYPH_W = 5;
+const int FONT_GLYPH_H = 7;
+const int FONT_ADVANCE = 6;   // Glyph plus one column of spacing
+const int FONT_LINE = 9;      // Glyph plus two rows of spacing
+// Layout cache slots (a power of two) and the longest string one slot holds;
+// longer strings are cut off
+const int TEXT_CACHE_SLOTS = 256;
+const int TEXT_MAX_LENGTH = 256;
+
+//structure
+struct Font {
+    int regions[FONT_GLYPHS];     // Atlas region per glyph
+};
+
+// Glyph quads of one string at scale 1 with its top-left at the origin.
+// Spaces and newlines take no quads.
+struct TextLayout {
+    Uint64 hash;
+    int length;                   // 0 = empty slot
+    char text[TEXT_MAX_LENGTH];   // Compared on a hash match
+    int firstVertex;              // Into TextCache::vertices
+    int quadCount;
+    float width, height;
+};
+
+// Direct-mapped cache of string layouts keyed by content hash. Everything is
+// allocated up front, so laying out and drawing text never allocates.
+struct TextCache {
+    std::vector<TextLayout> slots;
+    std::vector<SDL_Vertex> vertices;  // TEXT_MAX_LENGTH quads per slot
+    Uint64 hits, misses;
+};
+
+//function definaction
+// Pack the glyphs into the atlas; call before finalizeAtlas
+bool loadFont(Font& font, Atlas& atlas);
+void initTextCache(TextCache& cache);
+void clearTextCache(TextCache& cache);
+// Layout of text, built on a miss. UVs come from atlas, so clear the cache
+// if the atlas is ever repacked.
+const TextLayout& layoutText(TextCache& cache, const Font& font, const Atlas& atlas, const char* text);
+// Draw text with its top-left at (x, y), scale pixels per font texel, as a
+// single quad batch. Returns the width drawn.
+float drawText(DrawList& list, TextCache& cache, const Font& font, const Atlas& atlas, const char* text,
+               float x, float y, float scale, SDL_Color color);